@@ -0,0 +1,213 @@
+//---------------------------------------------------------------
+//
+// Bitboard.cpp
+//
+
+#include "Bitboard.h"
+
+#include <cstddef>
+#include <vector>
+
+#if CHESS_HAS_PEXT && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+namespace Chess {
+
+//===============================================================================
+
+bool s_useSliderPext = false;
+
+std::array<Magic, s_numSquares> s_rookMagics;
+std::array<Magic, s_numSquares> s_bishopMagics;
+
+std::array<std::array<Bitboard, s_numSquares>, s_numSquares> s_betweenSquares;
+std::array<std::array<Bitboard, s_numSquares>, s_numSquares> s_lineSquares;
+
+// Every relevant-occupancy subset of every square, packed back to back. The sizes are the sums
+// of 2^(number of mask bits) over all squares.
+static std::array<Bitboard, 0x19000> s_rookTable;
+static std::array<Bitboard, 0x1480> s_bishopTable;
+
+// File and rank deltas for each sliding direction.
+static const std::array<std::array<int32_t, 2>, 4> s_rookSteps{{ {0, 1}, {0, -1}, {1, 0}, {-1, 0} }};
+static const std::array<std::array<int32_t, 2>, 4> s_bishopSteps{{ {1, 1}, {1, -1}, {-1, 1}, {-1, -1} }};
+
+// Fixed seeds that find all magics quickly with the generator below.
+static const std::array<uint64_t, 8> s_magicSeeds{{ 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 }};
+
+// Returns whether the CPU we are running on supports BMI2 (and so PEXT).
+static bool HostHasBmi2()
+{
+#if CHESS_HAS_PEXT && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 8)) != 0;
+#elif CHESS_HAS_PEXT
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+	{
+		return false;
+	}
+	return (ebx & (1u << 8)) != 0;
+#else
+	return false;
+#endif
+}
+
+// xorshift64* pseudo random number generator, good enough for finding magics.
+class MagicRng {
+public:
+	MagicRng(uint64_t seed) : m_state(seed) {}
+
+	uint64_t Next()
+	{
+		m_state ^= m_state >> 12;
+		m_state ^= m_state << 25;
+		m_state ^= m_state >> 27;
+		return m_state * 2685821657736338717ULL;
+	}
+
+	// Magics with few set bits are found much faster.
+	uint64_t NextSparse() { return Next() & Next() & Next(); }
+
+private:
+	uint64_t m_state;
+};
+
+// Walks each direction from the square until it leaves the board or hits an occupied square.
+static Bitboard GetSlidingAttacks(const std::array<std::array<int32_t, 2>, 4>& steps,
+	Square square, Bitboard occupied)
+{
+	Bitboard attacks = 0;
+	for (const auto& step : steps)
+	{
+		int32_t file = FileOf(square) + step[0];
+		int32_t rank = RankOf(square) + step[1];
+		while (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+		{
+			Square dest = MakeSquare(file, rank);
+			attacks |= SquareBit(dest);
+			if (IsSet(occupied, dest))
+			{
+				break;
+			}
+			file += step[0];
+			rank += step[1];
+		}
+	}
+	return attacks;
+}
+
+static void InitMagics(const std::array<std::array<int32_t, 2>, 4>& steps,
+	std::array<Magic, s_numSquares>& magics, Bitboard* table)
+{
+	std::vector<Bitboard> occupancy(4096);
+	std::vector<Bitboard> reference(4096);
+	std::vector<int32_t> epoch(4096, 0);
+	int32_t attempt = 0;
+
+	Bitboard* attacks = table;
+	for (Square square = 0; square < s_numSquares; ++square)
+	{
+		Magic& m = magics[square];
+
+		// Pieces on the board edge never block anything further along, so they are left out.
+		Bitboard edges = ((s_rank1 | s_rank8) & ~(s_rank1 << (8 * RankOf(square))))
+			| ((s_fileA | s_fileH) & ~(s_fileA << FileOf(square)));
+		m.mask = GetSlidingAttacks(steps, square, 0) & ~edges;
+		m.shift = 64 - PopCount(m.mask);
+		m.attacks = attacks;
+
+		// Enumerate every subset of the mask (carry-rippler) with its attack set.
+		int32_t size = 0;
+		Bitboard subset = 0;
+		do
+		{
+			occupancy[size] = subset;
+			reference[size] = GetSlidingAttacks(steps, square, subset);
+			++size;
+			subset = (subset - m.mask) & m.mask;
+		} while (subset);
+
+		attacks += size;
+
+		// PEXT packs each subset to a unique index of its own, no magic needed.
+		if (s_useSliderPext)
+		{
+			for (int32_t i = 0; i < size; ++i)
+			{
+				m.attacks[m.GetIndex(occupancy[i])] = reference[i];
+			}
+			continue;
+		}
+
+		// Try random magics until every subset maps to a slot without a destructive collision.
+		MagicRng rng(s_magicSeeds[RankOf(square)]);
+		for (int32_t i = 0; i < size; )
+		{
+			do
+			{
+				m.magic = rng.NextSparse();
+			} while (PopCount((m.magic * m.mask) >> 56) < 6);
+
+			++attempt;
+			for (i = 0; i < size; ++i)
+			{
+				uint32_t index = m.GetIndex(occupancy[i]);
+				if (epoch[index] < attempt)
+				{
+					epoch[index] = attempt;
+					m.attacks[index] = reference[i];
+				}
+				else if (m.attacks[index] != reference[i])
+				{
+					break;
+				}
+			}
+		}
+	}
+}
+
+void InitAttackTables()
+{
+	s_useSliderPext = HostHasBmi2();
+
+	InitMagics(s_rookSteps, s_rookMagics, s_rookTable.data());
+	InitMagics(s_bishopSteps, s_bishopMagics, s_bishopTable.data());
+
+	for (Square from = 0; from < s_numSquares; ++from)
+	{
+		for (Square to = 0; to < s_numSquares; ++to)
+		{
+			s_betweenSquares[from][to] = 0;
+			s_lineSquares[from][to] = 0;
+
+			Bitboard ends = SquareBit(from) | SquareBit(to);
+			if (IsSet(GetRookAttacks(from, 0), to))
+			{
+				s_betweenSquares[from][to] = GetRookAttacks(from, SquareBit(to)) & GetRookAttacks(to, SquareBit(from));
+				s_lineSquares[from][to] = (GetRookAttacks(from, 0) & GetRookAttacks(to, 0)) | ends;
+			}
+			else if (IsSet(GetBishopAttacks(from, 0), to))
+			{
+				s_betweenSquares[from][to] = GetBishopAttacks(from, SquareBit(to)) & GetBishopAttacks(to, SquareBit(from));
+				s_lineSquares[from][to] = (GetBishopAttacks(from, 0) & GetBishopAttacks(to, 0)) | ends;
+			}
+		}
+	}
+}
+
+const char* GetSliderKernelName()
+{
+	return s_useSliderPext ? "PEXT (BMI2)" : "magic multiply";
+}
+
+//===============================================================================
+
+} // namespace Chess
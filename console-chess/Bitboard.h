@@ -0,0 +1,239 @@
+//---------------------------------------------------------------
+//
+// Bitboard.h
+//
+
+#pragma once
+
+#include "ChessTypes.h"
+
+#include <array>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// PEXT is only worth having for 64-bit operands, so the BMI2 kernel is limited to x86-64 builds.
+// Whether the host actually supports it is decided at runtime by InitAttackTables.
+#if defined(_M_X64) || defined(__x86_64__)
+#define CHESS_HAS_PEXT 1
+#else
+#define CHESS_HAS_PEXT 0
+#endif
+
+namespace Chess {
+
+//===============================================================================
+
+constexpr Bitboard s_fileA = 0x0101010101010101ULL;
+constexpr Bitboard s_fileH = s_fileA << 7;
+constexpr Bitboard s_rank1 = 0xFFULL;
+constexpr Bitboard s_rank8 = s_rank1 << 56;
+
+constexpr Bitboard SquareBit(Square square) { return 1ULL << square; }
+
+constexpr bool IsSet(Bitboard b, Square square) { return (b & SquareBit(square)) != 0; }
+
+// Moves every square in the set Delta squares along the board, where +8 is one rank up. Squares
+// that would wrap around from the a file to the h file or back are dropped.
+template <int32_t Delta>
+constexpr Bitboard Shift(Bitboard b)
+{
+	static_assert(Delta == 8 || Delta == -8 || Delta == 7 || Delta == 9 || Delta == -7 || Delta == -9,
+		"Shift only supports single steps up, down and diagonally");
+	if constexpr (Delta == 8) return b << 8;
+	else if constexpr (Delta == -8) return b >> 8;
+	else if constexpr (Delta == 7) return (b & ~s_fileA) << 7;
+	else if constexpr (Delta == 9) return (b & ~s_fileH) << 9;
+	else if constexpr (Delta == -7) return (b & ~s_fileH) >> 7;
+	else return (b & ~s_fileA) >> 9;
+}
+
+// Returns the capture squares of every pawn in the set at once.
+constexpr Bitboard GetPawnAttacks(ColorId colorId, Bitboard pawns)
+{
+	return colorId == ColorId::WHITE
+		? Shift<7>(pawns) | Shift<9>(pawns)
+		: Shift<-9>(pawns) | Shift<-7>(pawns);
+}
+
+// File and rank deltas for each leaper move.
+using StepList = std::array<std::array<int32_t, 2>, 8>;
+
+constexpr StepList s_knightSteps{{
+	{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} }};
+constexpr StepList s_kingSteps{{
+	{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1} }};
+
+// Returns, for every square, the squares one step away in each direction that are still on the board.
+constexpr std::array<Bitboard, s_numSquares> MakeStepAttackTable(const StepList& steps)
+{
+	std::array<Bitboard, s_numSquares> table{};
+	for (Square square = 0; square < s_numSquares; ++square)
+	{
+		for (const auto& step : steps)
+		{
+			int32_t file = FileOf(square) + step[0];
+			int32_t rank = RankOf(square) + step[1];
+			if (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+			{
+				table[square] |= SquareBit(MakeSquare(file, rank));
+			}
+		}
+	}
+	return table;
+}
+
+constexpr std::array<std::array<Bitboard, s_numSquares>, s_numColors> MakePawnAttackTable()
+{
+	std::array<std::array<Bitboard, s_numSquares>, s_numColors> table{};
+	for (Square square = 0; square < s_numSquares; ++square)
+	{
+		table[ColorIndex(ColorId::WHITE)][square] = GetPawnAttacks(ColorId::WHITE, SquareBit(square));
+		table[ColorIndex(ColorId::BLACK)][square] = GetPawnAttacks(ColorId::BLACK, SquareBit(square));
+	}
+	return table;
+}
+
+// Leaper attacks depend on nothing but the square, so they are built by the compiler.
+inline constexpr std::array<Bitboard, s_numSquares> s_knightAttacks = MakeStepAttackTable(s_knightSteps);
+inline constexpr std::array<Bitboard, s_numSquares> s_kingAttacks = MakeStepAttackTable(s_kingSteps);
+inline constexpr std::array<std::array<Bitboard, s_numSquares>, s_numColors> s_pawnAttacks = MakePawnAttackTable();
+
+static_assert(s_knightAttacks[0] == (SquareBit(10) | SquareBit(17)), "Knight attack table is wrong");
+static_assert(s_kingAttacks[63] == (SquareBit(54) | SquareBit(55) | SquareBit(62)), "King attack table is wrong");
+
+constexpr Bitboard GetKnightAttacks(Square square) { return s_knightAttacks[square]; }
+constexpr Bitboard GetKingAttacks(Square square) { return s_kingAttacks[square]; }
+
+// Returns the squares a pawn of the given color on the square captures on.
+constexpr Bitboard GetPawnAttacks(ColorId colorId, Square square)
+{
+	return s_pawnAttacks[ColorIndex(colorId)][square];
+}
+
+// Returns the number of squares in the set.
+inline int32_t PopCount(Bitboard b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(b);
+#else
+	// POPCNT is not guaranteed on every host this is built for, so count in software.
+	b = b - ((b >> 1) & 0x5555555555555555ULL);
+	b = (b & 0x3333333333333333ULL) + ((b >> 2) & 0x3333333333333333ULL);
+	b = (b + (b >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int32_t>((b * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Returns the lowest square in a non-empty set.
+inline Square GetLsb(Bitboard b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(b);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, b);
+	return static_cast<Square>(index);
+#else
+	unsigned long index;
+	if (_BitScanForward(&index, static_cast<unsigned long>(b)))
+	{
+		return static_cast<Square>(index);
+	}
+	_BitScanForward(&index, static_cast<unsigned long>(b >> 32));
+	return static_cast<Square>(index + 32);
+#endif
+}
+
+// Removes the lowest square from a non-empty set and returns it.
+inline Square PopLsb(Bitboard& b)
+{
+	Square square = GetLsb(b);
+	b &= b - 1;
+	return square;
+}
+
+#if CHESS_HAS_PEXT
+// Gathers the bits of src selected by mask into the low bits of the result. Only call this
+// once InitAttackTables has confirmed the host supports BMI2.
+inline uint64_t Pext(uint64_t src, uint64_t mask)
+{
+#if defined(_MSC_VER)
+	return _pext_u64(src, mask);
+#else
+	// Inline asm rather than the intrinsic, so the rest of the binary does not need -mbmi2.
+	uint64_t result;
+	__asm__("pextq %2, %1, %0" : "=r"(result) : "r"(src), "r"(mask));
+	return result;
+#endif
+}
+#endif
+
+// Set once at startup. True when slider tables are indexed with PEXT instead of magics.
+extern bool s_useSliderPext;
+
+// Slider attack table entry for one square. The relevant occupancy is hashed into a dense
+// per-square slice of a shared attack table, either with a magic multiply or with PEXT.
+struct Magic {
+	// Squares whose occupancy can block the slider, board edges excluded.
+	Bitboard mask = 0;
+	Bitboard magic = 0;
+	Bitboard* attacks = nullptr;
+	uint32_t shift = 0;
+
+	uint32_t GetIndex(Bitboard occupied) const
+	{
+#if CHESS_HAS_PEXT
+		if (s_useSliderPext)
+		{
+			return static_cast<uint32_t>(Pext(occupied, mask));
+		}
+#endif
+		return static_cast<uint32_t>(((occupied & mask) * magic) >> shift);
+	}
+};
+
+extern std::array<Magic, s_numSquares> s_rookMagics;
+extern std::array<Magic, s_numSquares> s_bishopMagics;
+
+// Builds the slider and line tables, picking the PEXT kernel when the host supports BMI2. Must
+// be called once at startup, before any slider or line lookup. Leaper tables need no setup.
+void InitAttackTables();
+
+// Returns a short description of the slider kernel InitAttackTables picked, for logging.
+const char* GetSliderKernelName();
+
+// Returns the squares a rook on the square attacks given the occupied squares.
+inline Bitboard GetRookAttacks(Square square, Bitboard occupied)
+{
+	const Magic& m = s_rookMagics[square];
+	return m.attacks[m.GetIndex(occupied)];
+}
+
+// Returns the squares a bishop on the square attacks given the occupied squares.
+inline Bitboard GetBishopAttacks(Square square, Bitboard occupied)
+{
+	const Magic& m = s_bishopMagics[square];
+	return m.attacks[m.GetIndex(occupied)];
+}
+
+// Returns the squares a queen on the square attacks given the occupied squares.
+inline Bitboard GetQueenAttacks(Square square, Bitboard occupied)
+{
+	return GetRookAttacks(square, occupied) | GetBishopAttacks(square, occupied);
+}
+
+extern std::array<std::array<Bitboard, s_numSquares>, s_numSquares> s_betweenSquares;
+extern std::array<std::array<Bitboard, s_numSquares>, s_numSquares> s_lineSquares;
+
+// Returns the squares strictly between two squares on a shared rank, file or diagonal.
+// Empty if they are not aligned.
+inline Bitboard GetBetween(Square from, Square to) { return s_betweenSquares[from][to]; }
+
+// Returns the whole rank, file or diagonal through both squares. Empty if they are not aligned.
+inline Bitboard GetLine(Square from, Square to) { return s_lineSquares[from][to]; }
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,131 @@
+//---------------------------------------------------------------
+//
+// ChessTypes.h
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Chess {
+
+//===============================================================================
+
+enum struct PieceId : uint32_t
+{
+	NONE = 0,
+	EMPTY,
+	PAWN,
+	KNIGHT,
+	ROOK,
+	BISHOP,
+	QUEEN,
+	KING
+};
+
+enum struct ColorId : uint32_t {
+	NONE = 0,
+	WHITE,
+	BLACK
+};
+
+// A set of squares, one bit per square.
+using Bitboard = uint64_t;
+
+// Index of a square on the board. a1 = 0, b1 = 1, ..., h1 = 7, a2 = 8, ..., h8 = 63.
+using Square = int32_t;
+
+constexpr int32_t s_numColors = 2;
+constexpr int32_t s_numPieceTypes = 6;
+constexpr int32_t s_numSquares = 64;
+constexpr Square s_noSquare = 64;
+
+// Returns the table index [0, 1] of a color. Only valid for WHITE and BLACK.
+constexpr int32_t ColorIndex(ColorId colorId)
+{
+	return static_cast<int32_t>(colorId) - static_cast<int32_t>(ColorId::WHITE);
+}
+
+// Returns the table index [0, 5] of a piece. Only valid for PAWN through KING.
+constexpr int32_t PieceIndex(PieceId pieceId)
+{
+	return static_cast<int32_t>(pieceId) - static_cast<int32_t>(PieceId::PAWN);
+}
+
+// Inverse of PieceIndex.
+constexpr PieceId PieceFromIndex(int32_t index)
+{
+	return static_cast<PieceId>(index + static_cast<int32_t>(PieceId::PAWN));
+}
+
+// Returns the other side.
+constexpr ColorId GetOpponent(ColorId colorId)
+{
+	return colorId == ColorId::WHITE ? ColorId::BLACK : ColorId::WHITE;
+}
+
+// A piece and its color packed into one byte: the PieceId in bits 0-2 and the ColorId in bits 3-4.
+enum struct Piece : uint8_t {};
+
+constexpr Piece MakePiece(ColorId colorId, PieceId pieceId)
+{
+	return static_cast<Piece>(static_cast<uint32_t>(pieceId) | (static_cast<uint32_t>(colorId) << 3));
+}
+
+constexpr PieceId GetPieceId(Piece piece) { return static_cast<PieceId>(static_cast<uint8_t>(piece) & 7); }
+constexpr ColorId GetPieceColor(Piece piece) { return static_cast<ColorId>(static_cast<uint8_t>(piece) >> 3); }
+
+// What an empty square holds.
+constexpr Piece s_noPiece = MakePiece(ColorId::NONE, PieceId::EMPTY);
+
+static_assert(sizeof(Piece) == 1, "Piece must fit in a byte");
+static_assert(GetPieceColor(MakePiece(ColorId::BLACK, PieceId::KING)) == ColorId::BLACK, "Piece encoding is broken");
+
+// Facts about a kind of piece that do not depend on where it stands or on its color.
+struct PieceTypeInfo {
+	// Lowercase letter for the piece, as in FEN. White pieces are written in uppercase.
+	char letter;
+
+	// Material the piece is worth, in pawns, as traditionally counted. Zero for the king,
+	// which is never captured.
+	int32_t points;
+
+	// Whether it slides any number of squares rather than stepping once.
+	bool isSlider;
+};
+
+// Indexed by PieceIndex.
+constexpr std::array<PieceTypeInfo, s_numPieceTypes> s_pieceTypeInfos{{
+	{ 'p', 1, false },
+	{ 'n', 3, false },
+	{ 'r', 5, true },
+	{ 'b', 3, true },
+	{ 'q', 9, true },
+	{ 'k', 0, false },
+}};
+
+// Only valid for PAWN through KING.
+constexpr const PieceTypeInfo& GetPieceTypeInfo(PieceId pieceId) { return s_pieceTypeInfos[PieceIndex(pieceId)]; }
+
+// Returns the kind of piece a FEN letter of either case stands for, or EMPTY.
+constexpr PieceId GetPieceIdFromLetter(char letter)
+{
+	char lower = letter >= 'A' && letter <= 'Z' ? static_cast<char>(letter - 'A' + 'a') : letter;
+	for (int32_t i = 0; i < s_numPieceTypes; ++i)
+	{
+		if (s_pieceTypeInfos[i].letter == lower)
+		{
+			return PieceFromIndex(i);
+		}
+	}
+	return PieceId::EMPTY;
+}
+
+constexpr Square MakeSquare(int32_t file, int32_t rank) { return rank * 8 + file; }
+constexpr int32_t FileOf(Square square) { return square & 7; }
+constexpr int32_t RankOf(Square square) { return square >> 3; }
+
+//===============================================================================
+
+} // namespace Chess
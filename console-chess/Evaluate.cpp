@@ -0,0 +1,358 @@
+//---------------------------------------------------------------
+//
+// Evaluate.cpp
+//
+
+#include "Evaluate.h"
+#include "MoveGen.h"
+
+#include <algorithm>
+#include <cctype>
+#include <ostream>
+#include <string>
+
+namespace Chess {
+
+//===============================================================================
+
+using SquareTable = std::array<int32_t, s_numSquares>;
+
+// Bonus in centipawns for a piece standing on each square, written as white sees the board:
+// rank 8 first, so a white piece on square s reads entry s ^ 56 and a black piece entry s.
+// Indexed by PieceIndex.
+static const std::array<SquareTable, s_numPieceTypes> s_squareTables{{
+	// Pawn: push the center pawns, keep the ones in front of a castled king.
+	{{
+		 0,   0,   0,   0,   0,   0,   0,   0,
+		50,  50,  50,  50,  50,  50,  50,  50,
+		10,  10,  20,  30,  30,  20,  10,  10,
+		 5,   5,  10,  25,  25,  10,   5,   5,
+		 0,   0,   0,  20,  20,   0,   0,   0,
+		 5,  -5, -10,   0,   0, -10,  -5,   5,
+		 5,  10,  10, -20, -20,  10,  10,   5,
+		 0,   0,   0,   0,   0,   0,   0,   0,
+	}},
+	// Knight: centralize, avoid the rim.
+	{{
+		-50, -40, -30, -30, -30, -30, -40, -50,
+		-40, -20,   0,   0,   0,   0, -20, -40,
+		-30,   0,  10,  15,  15,  10,   0, -30,
+		-30,   5,  15,  20,  20,  15,   5, -30,
+		-30,   0,  15,  20,  20,  15,   0, -30,
+		-30,   5,  10,  15,  15,  10,   5, -30,
+		-40, -20,   0,   5,   5,   0, -20, -40,
+		-50, -40, -30, -30, -30, -30, -40, -50,
+	}},
+	// Rook: the seventh rank and the center files.
+	{{
+		 0,   0,   0,   0,   0,   0,   0,   0,
+		 5,  10,  10,  10,  10,  10,  10,   5,
+		-5,   0,   0,   0,   0,   0,   0,  -5,
+		-5,   0,   0,   0,   0,   0,   0,  -5,
+		-5,   0,   0,   0,   0,   0,   0,  -5,
+		-5,   0,   0,   0,   0,   0,   0,  -5,
+		-5,   0,   0,   0,   0,   0,   0,  -5,
+		 0,   0,   0,   5,   5,   0,   0,   0,
+	}},
+	// Bishop: long diagonals, away from corners.
+	{{
+		-20, -10, -10, -10, -10, -10, -10, -20,
+		-10,   0,   0,   0,   0,   0,   0, -10,
+		-10,   0,   5,  10,  10,   5,   0, -10,
+		-10,   5,   5,  10,  10,   5,   5, -10,
+		-10,   0,  10,  10,  10,  10,   0, -10,
+		-10,  10,  10,  10,  10,  10,  10, -10,
+		-10,   5,   0,   0,   0,   0,   5, -10,
+		-20, -10, -10, -10, -10, -10, -10, -20,
+	}},
+	// Queen: mildly central.
+	{{
+		-20, -10, -10,  -5,  -5, -10, -10, -20,
+		-10,   0,   0,   0,   0,   0,   0, -10,
+		-10,   0,   5,   5,   5,   5,   0, -10,
+		 -5,   0,   5,   5,   5,   5,   0,  -5,
+		  0,   0,   5,   5,   5,   5,   0,  -5,
+		-10,   5,   5,   5,   5,   5,   0, -10,
+		-10,   0,   5,   0,   0,   0,   0, -10,
+		-20, -10, -10,  -5,  -5, -10, -10, -20,
+	}},
+	// King: stay home behind the pawns.
+	{{
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-20, -30, -30, -40, -40, -30, -30, -20,
+		-10, -20, -20, -20, -20, -20, -20, -10,
+		 20,  20,   0,   0,   0,   0,  20,  20,
+		 20,  30,  10,   0,   0,  10,  30,  20,
+	}},
+}};
+
+// Returns the material and placement score of one side's pieces.
+static int32_t EvaluateSide(const Position& position, ColorId colorId)
+{
+	// Flips the tables, which are written for white, onto black's side of the board.
+	const Square flip = colorId == ColorId::WHITE ? 56 : 0;
+
+	int32_t score = 0;
+	for (int32_t pieceIndex = 0; pieceIndex < s_numPieceTypes; ++pieceIndex)
+	{
+		const int32_t value = s_pieceTypeInfos[pieceIndex].points * s_pawnValue;
+		const SquareTable& table = s_squareTables[pieceIndex];
+
+		Bitboard pieces = position.GetPieces(colorId, PieceFromIndex(pieceIndex));
+		while (pieces)
+		{
+			score += value + table[PopLsb(pieces) ^ flip];
+		}
+	}
+	return score;
+}
+
+int32_t Evaluate(const Position& position)
+{
+	ColorId us = position.GetSideToMove();
+	return EvaluateSide(position, us) - EvaluateSide(position, GetOpponent(us));
+}
+
+// Returns the material value of a kind of piece in centipawns.
+static int32_t GetPieceValue(PieceId pieceId)
+{
+	return GetPieceTypeInfo(pieceId).points * s_pawnValue;
+}
+
+// Pieces in the order a side recaptures with them, least valuable first.
+static const std::array<PieceId, s_numPieceTypes> s_recaptureOrder = {
+	PieceId::PAWN, PieceId::KNIGHT, PieceId::BISHOP, PieceId::ROOK, PieceId::QUEEN, PieceId::KING
+};
+
+int32_t EvaluateExchange(const Position& position, Move move)
+{
+	const Square from = move.GetFrom();
+	const Square to = move.GetTo();
+
+	// Material balance after each capture of the sequence, from the point of view of the side
+	// making it, assuming the piece it lands with is lost straight after. There cannot be more
+	// captures than pieces.
+	std::array<int32_t, 33> gains;
+	int32_t numCaptures = 0;
+
+	PieceId victimId = move.IsEnPassant() ? PieceId::PAWN : position.GetPieceIdAt(to);
+	PieceId attackerId = position.GetPieceIdAt(from);
+	gains[0] = victimId == PieceId::EMPTY ? 0 : GetPieceValue(victimId);
+	if (move.IsPromotion())
+	{
+		attackerId = move.GetPromotionPieceId();
+		gains[0] += GetPieceValue(attackerId) - GetPieceValue(PieceId::PAWN);
+	}
+
+	Bitboard occupied = position.GetOccupied() ^ SquareBit(from);
+	if (move.IsEnPassant())
+	{
+		occupied ^= SquareBit(to ^ 8);
+	}
+
+	const Bitboard diagonalSliders = position.GetPieces(ColorId::WHITE, PieceId::BISHOP)
+		| position.GetPieces(ColorId::BLACK, PieceId::BISHOP)
+		| position.GetPieces(ColorId::WHITE, PieceId::QUEEN) | position.GetPieces(ColorId::BLACK, PieceId::QUEEN);
+	const Bitboard straightSliders = position.GetPieces(ColorId::WHITE, PieceId::ROOK)
+		| position.GetPieces(ColorId::BLACK, PieceId::ROOK)
+		| position.GetPieces(ColorId::WHITE, PieceId::QUEEN) | position.GetPieces(ColorId::BLACK, PieceId::QUEEN);
+
+	Bitboard attackers = position.AttackersTo(to, occupied) & occupied;
+	ColorId side = GetOpponent(position.GetColorAt(from));
+	for (;;)
+	{
+		Bitboard sideAttackers = attackers & position.GetPieces(side);
+		if (!sideAttackers)
+		{
+			break;
+		}
+
+		// The least valuable attacker recaptures. A king may only do so if nothing defends.
+		Square square = s_noSquare;
+		PieceId recapturerId = PieceId::EMPTY;
+		for (PieceId pieceId : s_recaptureOrder)
+		{
+			Bitboard pieces = sideAttackers & position.GetPieces(side, pieceId);
+			if (pieces)
+			{
+				square = GetLsb(pieces);
+				recapturerId = pieceId;
+				break;
+			}
+		}
+		if (recapturerId == PieceId::KING && (attackers & position.GetPieces(GetOpponent(side)) & ~SquareBit(square)))
+		{
+			break;
+		}
+
+		++numCaptures;
+		gains[numCaptures] = GetPieceValue(attackerId) - gains[numCaptures - 1];
+		attackerId = recapturerId;
+
+		// Lifting the piece may uncover a slider behind it on the same line.
+		occupied ^= SquareBit(square);
+		attackers |= (GetBishopAttacks(to, occupied) & diagonalSliders) | (GetRookAttacks(to, occupied) & straightSliders);
+		attackers &= occupied;
+		side = GetOpponent(side);
+	}
+
+	// Either side may decline to capture, so each keeps the better of stopping and going on.
+	while (numCaptures > 0)
+	{
+		gains[numCaptures - 1] = -std::max(-gains[numCaptures - 1], gains[numCaptures]);
+		--numCaptures;
+	}
+	return gains[0];
+}
+
+Bitboard GetHangingPieces(const Position& position, ColorId colorId)
+{
+	const ColorId them = GetOpponent(colorId);
+	const CheckInfo theirCheckInfo = ComputeCheckInfo(position, them);
+	Bitboard pieces = position.GetPieces(colorId) & ~position.GetPieces(colorId, PieceId::KING);
+
+	Bitboard hanging = 0;
+	while (pieces)
+	{
+		Square square = PopLsb(pieces);
+		Bitboard squareAttackers = position.AttackersTo(square, position.GetOccupied());
+		Bitboard attackers = squareAttackers & position.GetPieces(them);
+
+		// Only captures that could be played count: the king cannot take a defended piece, and
+		// a pinned piece can only take along its pin.
+		if (squareAttackers & position.GetPieces(colorId))
+		{
+			attackers &= ~position.GetPieces(them, PieceId::KING);
+		}
+		Bitboard pinned = attackers & theirCheckInfo.pinned;
+		while (pinned)
+		{
+			Square pinnedSquare = PopLsb(pinned);
+			if (!(GetLine(theirCheckInfo.kingSquare, pinnedSquare) & SquareBit(square)))
+			{
+				attackers &= ~SquareBit(pinnedSquare);
+			}
+		}
+
+		while (attackers)
+		{
+			if (EvaluateExchange(position, Move(PopLsb(attackers), square, CAPTURE)) > 0)
+			{
+				hanging |= SquareBit(square);
+				break;
+			}
+		}
+	}
+	return hanging;
+}
+
+struct ExchangeCase {
+	const char* fen;
+	const char* move;
+	int32_t expectedScore;
+};
+
+// Exchanges with their outcome worked out by hand: x-rays, en passant, promotions and a king
+// that may only recapture when nothing defends.
+static const std::array<ExchangeCase, 9> s_exchangeSuite{{
+	{ "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100 },
+	{ "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -200 },
+	{ "4k3/8/2p5/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", 0 },
+	{ "4k3/8/2p5/3p4/8/8/3R4/3RK3 w - - 0 1", "d2d5", -300 },
+	{ "3qk3/8/8/3p4/8/8/3Q4/3RK3 w - - 0 1", "d2d5", 100 },
+	{ "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100 },
+	{ "3rk3/2P5/8/8/8/8/8/4K3 w - - 0 1", "c7d8q", 400 },
+	{ "4k3/8/8/4p3/3P4/8/8/4K3 b - - 0 1", "e5d4", 100 },
+	{ "8/8/8/3k4/4p3/8/8/4RK2 w - - 0 1", "e1e4", -400 },
+}};
+
+struct HangingCase {
+	const char* fen;
+
+	// Hanging pieces of the side to move, as the game view lists them.
+	const char* expected;
+};
+
+static const std::array<HangingCase, 4> s_hangingSuite{{
+	// Kxe5 is illegal with d4 defending.
+	{ "8/8/4k3/4N3/3P4/8/8/4K3 w - - 0 1", "" },
+	{ "4k3/8/4n3/8/3B4/8/8/K6R w - - 0 1", "Bd4" },
+	// The knight is pinned to its king.
+	{ "4k3/8/4n3/8/3B4/8/8/K3R3 w - - 0 1", "" },
+	// The bishop is pinned, but may take along the pin.
+	{ "7k/6b1/8/4R3/8/8/8/K7 w - - 0 1", "Re5" },
+}};
+
+// Returns the legal move written in coordinate notation, or Move::None() if there is none.
+static Move FindMove(const Position& position, const std::string& moveString)
+{
+	MoveList moves;
+	GenerateLegalMoves(position, ComputeCheckInfo(position), moves, MoveGenTypeId::ALL);
+	for (int32_t i = 0; i < moves.GetSize(); ++i)
+	{
+		if (GetMoveString(moves[i]) == moveString)
+		{
+			return moves[i];
+		}
+	}
+	return Move::None();
+}
+
+std::string GetPiecesString(const Position& position, Bitboard pieces)
+{
+	std::string str;
+	while (pieces)
+	{
+		Square square = PopLsb(pieces);
+		str += str.empty() ? "" : " ";
+		str += static_cast<char>(std::toupper(GetPieceTypeInfo(position.GetPieceIdAt(square)).letter));
+		str += static_cast<char>('a' + FileOf(square));
+		str += static_cast<char>('1' + RankOf(square));
+	}
+	return str;
+}
+
+bool RunExchangeSuite(std::ostream& out)
+{
+	bool allPassed = true;
+	for (const ExchangeCase& exchangeCase : s_exchangeSuite)
+	{
+		Position position;
+		position.SetFromFen(exchangeCase.fen);
+		Move move = FindMove(position, exchangeCase.move);
+		int32_t score = move == Move::None() ? 0 : EvaluateExchange(position, move);
+
+		bool passed = move != Move::None() && score == exchangeCase.expectedScore;
+		allPassed = allPassed && passed;
+		out << (passed ? "ok   " : "FAIL ") << exchangeCase.move << " " << exchangeCase.fen << ": " << score;
+		if (!passed)
+		{
+			out << " (expected " << exchangeCase.expectedScore << ")";
+		}
+		out << "\n";
+	}
+
+	for (const HangingCase& hangingCase : s_hangingSuite)
+	{
+		Position position;
+		position.SetFromFen(hangingCase.fen);
+		std::string hanging = GetPiecesString(position, GetHangingPieces(position, position.GetSideToMove()));
+
+		bool passed = hanging == hangingCase.expected;
+		allPassed = allPassed && passed;
+		out << (passed ? "ok   " : "FAIL ") << "hanging " << hangingCase.fen << ": \"" << hanging << "\"";
+		if (!passed)
+		{
+			out << " (expected \"" << hangingCase.expected << "\")";
+		}
+		out << "\n";
+	}
+	return allPassed;
+}
+
+//===============================================================================
+
+} // namespace Chess
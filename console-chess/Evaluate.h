@@ -0,0 +1,45 @@
+//---------------------------------------------------------------
+//
+// Evaluate.h
+//
+
+#pragma once
+
+#include "Position.h"
+
+#include <iosfwd>
+#include <string>
+
+namespace Chess {
+
+//===============================================================================
+
+// Centipawns a pawn is worth. Material is PieceTypeInfo::points in these units.
+constexpr int32_t s_pawnValue = 100;
+
+// Returns the static score of the position in centipawns, from the side to move's point of
+// view: positive when the side to move is better. Counts material and piece placement only.
+int32_t Evaluate(const Position& position);
+
+// Static exchange evaluation: returns the material, in centipawns, that the side making the
+// move wins or loses once every capture back and forth on its to square has been played out,
+// each side capturing with its least valuable piece and free to stop when carrying on would
+// lose. Works on attack bitboards alone, uncovering x-ray attackers behind the pieces as they
+// go, and never makes a move. Pins and recaptures that promote are not taken into account.
+int32_t EvaluateExchange(const Position& position, Move move);
+
+// Returns the pieces of the given color, the king aside, that the other side can capture
+// for a material gain. Captures by a pinned piece off its pin, or by the king onto a defended
+// square, are not counted.
+Bitboard GetHangingPieces(const Position& position, ColorId colorId);
+
+// Returns the pieces on the given squares by letter and square, e.g. "Nf3 Pe4".
+std::string GetPiecesString(const Position& position, Bitboard pieces);
+
+// Runs the exchange evaluation and the hanging piece check over a fixed set of positions with
+// known results and prints each. Returns whether every result matched.
+bool RunExchangeSuite(std::ostream& out);
+
+//===============================================================================
+
+} // namespace Chess
@@ -5,61 +5,22 @@
 
 #pragma once
 
-#include <glm/glm.hpp>
-#include <array>
+#include "MoveGen.h"
+#include "Position.h"
+
+#include <algorithm>
 #include <vector>
 
 namespace Chess {
 
 //===============================================================================
 
-enum struct PieceId : uint32_t
-{
-	NONE = 0,
-	EMPTY,
-	PAWN,
-	KNIGHT,
-	ROOK,
-	BISHOP,
-	QUEEN,
-	KING
-};
-
-enum struct ColorId : uint32_t {
-	NONE = 0,
-	WHITE,
-	BLACK
-};
-
-enum struct AffinityId : uint32_t {
-	NONE,
-	FRIENDLY,
-	ENEMY
-};
-
 enum struct GameResolutionId : uint32_t {
 	NONE = 0,
 	BASIC_STALEMATE,
 	CHECKMATE
 };
 
-struct PieceInfo {
-	// Indicates the kind of piece.
-	PieceId pieceId = PieceId::NONE;
-
-	// Indicates which color the piece is.
-	ColorId colorId = ColorId::NONE;
-
-	// Number of points that a piece is worth.
-	int32_t points = 0;
-
-	// Max number of steps that the piece is allowed to move in a turn.
-	int32_t maxNumSteps = 0;
-
-	// List of valid directions this piece is allowed to move.
-	std::vector<glm::ivec2> directions;
-};
-
 class Player {
 public:
 	Player(ColorId colorId)
@@ -73,18 +34,19 @@ public:
 		m_capturedPieces.reserve(maxNumPieces);
 	}
 
-	void OnPieceCaptured(PieceInfo const* capturedPiece)
+	void OnPieceCaptured(Piece capturedPiece)
 	{
 		m_capturedPieces.push_back(capturedPiece);
+		m_score += GetPieceTypeInfo(GetPieceId(capturedPiece)).points;
 
 		std::sort(std::begin(m_capturedPieces), std::end(m_capturedPieces),
-			[this](const auto& lhs, const auto& rhs)
+			[](Piece lhs, Piece rhs)
 		{
-			return lhs->pieceId < rhs->pieceId;
+			return GetPieceId(lhs) < GetPieceId(rhs);
 		});
 	}
 
-	const std::vector<PieceInfo const*>& GetCapturedPieces()
+	const std::vector<Piece>& GetCapturedPieces()
 	{
 		return m_capturedPieces;
 	}
@@ -97,25 +59,31 @@ public:
 private:
 	int32_t m_score = 0;
 	ColorId m_colorId = ColorId::NONE;
-	std::vector<PieceInfo const*> m_capturedPieces;
+	std::vector<Piece> m_capturedPieces;
 	bool m_isInCheck = false;
-	bool m_hasMovedKing = false;
 };
 
-using ChessBoard = std::array<std::array<PieceInfo, 8>, 8>;
 class Game {
 
 public:
 	Game();
 
 	// Returns the board data.
-	const ChessBoard& GetChessBoard() { return m_board; }
+	const Position& GetChessBoard() { return m_board; }
 
 	// Returns the current player.
 	Player* GetCurrentPlayer() { return m_currentPlayer; }
 
-	// Begin trying to move the piece from the source to the dest.
-	bool MovePiece(const std::string& source, const std::string& dest);
+	// Plays the legal move going between the same squares as the requested move, if there is
+	// one. The played move carries the real flags. For a pawn reaching the last rank, the
+	// requested move's promotion piece is used, or a queen if it does not ask for a promotion.
+	bool MovePiece(Move requestedMove);
+
+	// Returns every move played so far, oldest first.
+	const std::vector<Move>& GetMoveHistory() const { return m_moveHistory; }
+
+	// Returns the hash of the position before each move played so far, oldest first.
+	const std::vector<uint64_t>& GetHashHistory() const { return m_hashHistory; }
 
 	// Flips the current player's turn. All functions operate in the context of the current player.
 	void TogglePlayer();
@@ -123,44 +91,16 @@ public:
 	GameResolutionId GetResolutionState();
 
 private:
-	const PieceInfo& GetPieceAt(const ChessBoard& board, const glm::ivec2& source);
-	void SetPieceAt(ChessBoard& board, const glm::ivec2& dest, const PieceInfo& piece);
-
-	// Returns a list of available moves given a piece on a given board.
-	std::vector<glm::ivec2> GetValidDestList(const ChessBoard& board, const glm::ivec2& source, const PieceInfo& piece);
-	void HandlePawnSpecialCase(const ChessBoard& board, std::vector<glm::ivec2>& destList,
-		const glm::ivec2& source, ColorId id);
-	void HandleCastleSpecialCase(const ChessBoard& board, std::vector<glm::ivec2>& destList,
-		const glm::ivec2& source, ColorId id);
-
-	// Physically place the piece.
-	void DoMovePiece(ChessBoard& board, const glm::ivec2& source, const glm::ivec2& dest, const PieceInfo& piece);
-
-	// Returns a list of piece positions that cause a check.
-	std::vector<glm::ivec2> SearchForCheck(const ChessBoard& data);
-
-	bool CurrentPlayerHasValidMove();
-
-	// Helper for getting the current king position.
-	glm::ivec2 GetKingPos(const ChessBoard& board);
+	// Returns whether the side to move has at least one legal move.
+	bool CurrentPlayerHasValidMove(const CheckInfo& checkInfo);
 
 	// Initializes the board.
 	void SetupBoard();
 
-	// Returns the affinity between an attacking piece and a defending piece.
-	AffinityId GetAffinity(const PieceInfo& attacker, const PieceInfo& defender);
-
-	// Returns the affinity of a given piece to the current player.
-	AffinityId GetAffinity(const PieceInfo& piece);
-
-	// Returns the affinity between two given pieces.
-	AffinityId DoGetAffinity(const ColorId& lhs, const ColorId& rhs);
-
-	// Returns whether the given coordinate is on the board.
-	bool IsCoordInBounds(const ChessBoard& board, const glm::ivec2& coord);
-
 private:
-	ChessBoard m_board;
+	Position m_board;
+	std::vector<Move> m_moveHistory;
+	std::vector<uint64_t> m_hashHistory;
 	GameResolutionId m_gameResolutionState = GameResolutionId::NONE;
 
 	Player m_whitePlayer;
@@ -12,6 +12,7 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <iterator>
 #include <iostream>
 
 namespace Chess {
@@ -21,9 +22,13 @@ namespace Chess {
 	static const int s_numNumberInputs = 2;
 	static const int s_numCharactersPerInput = 2;
 
-GameController::GameController()
+GameController::GameController(ColorId computerColorId, const SearchLimits& computerLimits,
+	const SearchOptions& searchOptions)
 	: m_game(std::make_unique<Game>())
 	, m_view(std::make_unique<GameView>(m_game.get()))
+	, m_computerColorId(computerColorId)
+	, m_computerLimits(computerLimits)
+	, m_search(searchOptions)
 {
 }
 
@@ -39,19 +44,12 @@ void GameController::Run()
 	bool done = false;
 	while (!done)
 	{
-
-		const auto& input = GetMoveInput();
-		const std::string& source = input.first;
-		const std::string& dest = input.second;
-
-		bool success = m_game->MovePiece(source, dest);
+		bool isComputerTurn = m_game->GetCurrentPlayer()->GetColor() == m_computerColorId;
+		bool success = m_game->MovePiece(isComputerTurn ? GetComputerMove() : GetMoveInput());
 		while (!success)
 		{
 			m_view->OnMoveFailed();
-			const auto& input = GetMoveInput();
-			const std::string& source = input.first;
-			const std::string& dest = input.second;
-			success = m_game->MovePiece(source, dest);
+			success = m_game->MovePiece(GetMoveInput());
 		}
 		m_view->DisplayBoard();
 
@@ -77,7 +75,21 @@ void GameController::Run()
 	}
 }
 
-MoveInput GameController::GetMoveInput()
+Move GameController::GetComputerMove()
+{
+	SearchInfo info = m_search.Run(m_game->GetChessBoard(), m_game->GetHashHistory(), m_computerLimits,
+		[this](const SearchInfo& iteration)
+	{
+		m_view->OnSearchIteration(iteration);
+	});
+
+	// The game ends before a side with no legal move is asked for one, so there is always a PV.
+	Move move = info.pv.empty() ? Move::None() : info.pv.front();
+	m_view->OnComputerMove(move);
+	return move;
+}
+
+Move GameController::GetMoveInput()
 {
 	std::vector<std::string> inputList;
 	bool isValidInput = false;
@@ -91,11 +103,12 @@ MoveInput GameController::GetMoveInput()
 
 		if (!isValidInput)
 		{
-			std::cout << "\n" << "Invalid input. Must in in format: [a-h][1-8]\n";
+			std::cout << "\n" << "Invalid input. Must in in format: [a-h][1-8] [a-h][1-8] [q|r|b|n]\n";
 		}
 	}
 
-	return { inputList[0], inputList[1] };
+	uint16_t flags = inputList.size() > s_numNumberInputs ? ParsePromotionFlags(inputList[2]) : static_cast<uint16_t>(QUIET);
+	return Move(ParseSquare(inputList[0]), ParseSquare(inputList[1]), flags);
 }
 
 std::vector<std::string> GameController::TokenizeString(const std::string& str)
@@ -107,13 +120,17 @@ std::vector<std::string> GameController::TokenizeString(const std::string& str)
 
 bool GameController::IsValidInput(const std::vector<std::string>& inputTokens)
 {
-	// Any input other than a source and a destination is invalid.
-	if (inputTokens.size() != s_numNumberInputs)
+	// Any input other than a source, a destination and an optional promotion piece is invalid.
+	if (inputTokens.size() != s_numNumberInputs && inputTokens.size() != s_numNumberInputs + 1)
+	{
+		return false;
+	}
+	if (inputTokens.size() > s_numNumberInputs && !IsValidPromotionInput(inputTokens.back()))
 	{
 		return false;
 	}
 
-	return std::all_of(std::cbegin(inputTokens), std::cend(inputTokens),
+	return std::all_of(std::cbegin(inputTokens), std::cbegin(inputTokens) + s_numNumberInputs,
 		[this](const std::string& inputStr)
 	{
 		return IsValidMoveInput(inputStr);
@@ -142,6 +159,46 @@ bool GameController::IsValidMoveInput(const std::string& str)
 	return true;
 }
 
+bool GameController::IsValidPromotionInput(const std::string& str)
+{
+	// input should be one of q, r, b or n
+	if (str.size() != 1)
+	{
+		return false;
+	}
+
+	PieceId pieceId = GetPieceIdFromLetter(str[0]);
+	return pieceId == PieceId::QUEEN || pieceId == PieceId::ROOK
+		|| pieceId == PieceId::BISHOP || pieceId == PieceId::KNIGHT;
+}
+
+Square GameController::ParseSquare(const std::string& str)
+{
+	// Only called on input that passed IsValidMoveInput.
+	char letterCoord = static_cast<char>(std::tolower(str[0]));
+	char numberCoord = str[1];
+	return MakeSquare(letterCoord - 'a', numberCoord - '1');
+}
+
+uint16_t GameController::ParsePromotionFlags(const std::string& str)
+{
+	// Only called on input that passed IsValidPromotionInput. Whether it captures is left to
+	// the game to work out.
+	switch (GetPieceIdFromLetter(str[0]))
+	{
+	case PieceId::KNIGHT:
+		return KNIGHT_PROMOTION;
+	case PieceId::BISHOP:
+		return BISHOP_PROMOTION;
+	case PieceId::ROOK:
+		return ROOK_PROMOTION;
+	case PieceId::QUEEN:
+	[[fallthrough]];
+	default:
+		return QUEEN_PROMOTION;
+	}
+}
+
 //===============================================================================
 
 } // namespace Chess
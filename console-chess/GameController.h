@@ -5,39 +5,52 @@
 
 #pragma once
 
+#include "Move.h"
+#include "Search.h"
+
 #include <memory>
 #include <string>
-#include <utility>
 #include <vector>
 
 namespace Chess {
 
 //===============================================================================
 
-using MoveInput = std::pair<std::string, std::string>;
-
 class Game;
 class GameView;
 class GameController {
 
 public:
-	GameController();
+	// The computer plays the given color, searching within the given limits. With ColorId::NONE
+	// both sides are played from the console.
+	explicit GameController(ColorId computerColorId = ColorId::NONE, const SearchLimits& computerLimits = {},
+		const SearchOptions& searchOptions = {});
 	~GameController();
 
 	void Run();
 
 private:
 
+	// Returns the move the computer plays in the current position.
+	Move GetComputerMove();
+
 	// Input helpers. These could be just static functions.
-	MoveInput GetMoveInput();
+	Move GetMoveInput();
 	std::vector<std::string> TokenizeString(const std::string& input);
 	bool IsValidInput(const std::vector<std::string>& inputTokens);
 	bool IsValidMoveInput(const std::string& str);
+	bool IsValidPromotionInput(const std::string& str);
+	Square ParseSquare(const std::string& str);
+	uint16_t ParsePromotionFlags(const std::string& str);
 
 
 private:
 	std::unique_ptr<Game> m_game;
 	std::unique_ptr<GameView> m_view;
+
+	ColorId m_computerColorId = ColorId::NONE;
+	SearchLimits m_computerLimits;
+	Search m_search;
 };
 
 
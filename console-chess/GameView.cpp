@@ -4,7 +4,9 @@
 //
 
 #include "GameView.h"
+#include "Evaluate.h"
 #include "Game.h"
+#include "Search.h"
 
 #include <cctype>
 #include <sstream>
@@ -14,55 +16,17 @@ namespace Chess {
 
 //===============================================================================
 
-static char GetPieceView(const PieceInfo& info)
+static char GetPieceView(Piece piece)
 {
-	char piece = ' ';
-	switch (info.pieceId)
+	if (piece == s_noPiece)
 	{
-	case PieceId::PAWN:
-		piece = 'p';
-		break;
-	case PieceId::KNIGHT:
-		piece = 'n';
-		break;
-	case PieceId::ROOK:
-		piece = 'r';
-		break;
-	case PieceId::BISHOP:
-		piece = 'b';
-		break;
-	case PieceId::QUEEN:
-		piece = 'q';
-		break;
-	case PieceId::KING:
-		piece = 'k';
-		break;
-	case PieceId::NONE:
-	[[fallthrough]];
-	case PieceId::EMPTY:
-	[[fallthrough]];
-	default:
-		piece = '.';
-		break;
+		return '.';
 	}
 
-	switch (info.colorId)
-	{
-	case ColorId::WHITE:
-		piece = std::toupper(piece);
-		break;
-	case ColorId::BLACK:
-	[[fallthrough]];
-	case ColorId::NONE:
-	[[fallthrough]];
-	default:
-		break;
-	}
-
-	return piece;
+	char letter = GetPieceTypeInfo(GetPieceId(piece)).letter;
+	return GetPieceColor(piece) == ColorId::WHITE ? static_cast<char>(std::toupper(letter)) : letter;
 }
 
-
 GameView::GameView(Game* game)
 	: m_game(game)
 {
@@ -71,18 +35,18 @@ GameView::GameView(Game* game)
 
 void GameView::DisplayBoard()
 {
-	const auto& data = m_game->GetChessBoard();
+	const auto& board = m_game->GetChessBoard();
 
-	char row = '8';
 	char col = 'A';
 
 	std::stringstream ss;
-	for (const auto& pieces : data)
+	for (int32_t rank = 7; rank >= 0; --rank)
 	{
-		ss << "|" << row-- << " ";
-		for (const auto& piece : pieces)
+		ss << "|" << static_cast<char>('1' + rank) << " ";
+		for (int32_t file = 0; file < 8; ++file)
 		{
-			ss << GetPieceView(piece);
+			Square square = MakeSquare(file, rank);
+			ss << GetPieceView(board.GetPieceAt(square));
 		}
 		ss << "\n";
 	}
@@ -121,6 +85,16 @@ void GameView::OnStalemate()
 	std::cout << "Stalemate.";
 }
 
+void GameView::OnSearchIteration(const SearchInfo& info)
+{
+	PrintSearchInfo(info, std::cout);
+}
+
+void GameView::OnComputerMove(Move move)
+{
+	std::cout << GetCurrentPlayerStr() << " plays " << GetMoveString(move) << "\n";
+}
+
 void GameView::OnTurnChange()
 {
 	const auto& player = m_game->GetCurrentPlayer();
@@ -130,6 +104,12 @@ void GameView::OnTurnChange()
 	{
 		std::cout << playerStr << "is in check!\n";
 	}
+
+	Bitboard hanging = GetHangingPieces(m_game->GetChessBoard(), player->GetColor());
+	if (hanging)
+	{
+		std::cout << "Hanging pieces: " << GetPiecesString(m_game->GetChessBoard(), hanging) << "\n";
+	}
 }
 
 std::string GameView::GetCurrentPlayerStr()
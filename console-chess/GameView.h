@@ -5,12 +5,15 @@
 
 #pragma once
 
+#include "Move.h"
+
 #include <string>
 
 namespace Chess {
 
 //===============================================================================
 class Game;
+struct SearchInfo;
 class GameView
 {
 public:
@@ -20,6 +23,8 @@ public:
 	void OnMoveFailed();
 	void OnCheckmate();
 	void OnStalemate();
+	void OnSearchIteration(const SearchInfo& info);
+	void OnComputerMove(Move move);
 	std::string GetCurrentPlayerStr();
 private:
 	Game* m_game;
@@ -0,0 +1,64 @@
+//---------------------------------------------------------------
+//
+// HashEntry.h
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Chess {
+
+//===============================================================================
+
+// One slot of a hash table shared by any number of threads without locks.
+//
+// The slot holds a data word and the key XORed with that word. A reader recomputes the key from
+// both; if two writers raced on the slot and left one's data with the other's check word, the
+// key does not come out and the slot reads as a miss. A torn entry is therefore never mistaken
+// for a hit, and no lock is needed to keep it whole.
+struct HashEntry {
+	std::atomic<uint64_t> check{ 0 };
+	std::atomic<uint64_t> data{ 0 };
+
+	// Returns whether the slot holds the key. data is filled either way, so that a caller
+	// choosing a slot to replace can weigh what is in it.
+	bool Load(uint64_t key, uint64_t& value) const
+	{
+		value = data.load(std::memory_order_relaxed);
+		return (check.load(std::memory_order_relaxed) ^ value) == key;
+	}
+
+	void Save(uint64_t key, uint64_t value)
+	{
+		data.store(value, std::memory_order_relaxed);
+		check.store(key ^ value, std::memory_order_relaxed);
+	}
+
+	void Clear()
+	{
+		check.store(0, std::memory_order_relaxed);
+		data.store(0, std::memory_order_relaxed);
+	}
+};
+
+static_assert(sizeof(HashEntry) == 16, "HashEntry must stay 16 bytes");
+
+// Returns how many slots of the given size a table of the given megabytes holds, rounded down
+// to a power of two so that a key masked with the count minus one indexes it. At least one.
+inline std::size_t GetHashTableSize(std::size_t megabytes, std::size_t slotBytes)
+{
+	std::size_t maxSlots = megabytes * 1024 * 1024 / slotBytes;
+	std::size_t numSlots = 1;
+	while (numSlots * 2 <= maxSlots)
+	{
+		numSlots *= 2;
+	}
+	return numSlots;
+}
+
+//===============================================================================
+
+} // namespace Chess
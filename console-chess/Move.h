@@ -0,0 +1,128 @@
+//---------------------------------------------------------------
+//
+// Move.h
+//
+
+#pragma once
+
+#include "ChessTypes.h"
+
+#include <array>
+#include <string>
+
+namespace Chess {
+
+//===============================================================================
+
+// What kind of move a Move is, stored in its top four bits. Bit 2 marks captures and bit 3
+// promotions; the low two bits of a promotion select the piece.
+enum MoveFlag : uint16_t {
+	QUIET = 0,
+	DOUBLE_PAWN_PUSH = 1,
+	KING_CASTLE = 2,
+	QUEEN_CASTLE = 3,
+	CAPTURE = 4,
+	EN_PASSANT = 5,
+	KNIGHT_PROMOTION = 8,
+	BISHOP_PROMOTION = 9,
+	ROOK_PROMOTION = 10,
+	QUEEN_PROMOTION = 11,
+	KNIGHT_PROMOTION_CAPTURE = 12,
+	BISHOP_PROMOTION_CAPTURE = 13,
+	ROOK_PROMOTION_CAPTURE = 14,
+	QUEEN_PROMOTION_CAPTURE = 15
+};
+
+// A move packed into 16 bits: the from square in bits 0-5, the to square in bits 6-11 and a
+// MoveFlag in bits 12-15.
+class Move {
+public:
+	// Left uninitialized so that arrays of moves cost nothing to create.
+	Move() = default;
+
+	constexpr Move(Square from, Square to, uint16_t flags = QUIET)
+		: m_data(static_cast<uint16_t>(from | (to << 6) | (flags << 12)))
+	{
+	}
+
+	// The all-zero move (a1 to a1), which is never a real move.
+	static constexpr Move None() { return FromData(0); }
+
+	// Rebuilds a move from the raw value returned by GetData.
+	static constexpr Move FromData(uint16_t data)
+	{
+		Move move(0, 0);
+		move.m_data = data;
+		return move;
+	}
+
+	constexpr Square GetFrom() const { return m_data & 0x3F; }
+	constexpr Square GetTo() const { return (m_data >> 6) & 0x3F; }
+	constexpr uint16_t GetFlags() const { return m_data >> 12; }
+	constexpr uint16_t GetData() const { return m_data; }
+
+	constexpr bool IsCapture() const { return (GetFlags() & CAPTURE) != 0; }
+	constexpr bool IsPromotion() const { return (GetFlags() & KNIGHT_PROMOTION) != 0; }
+	constexpr bool IsEnPassant() const { return GetFlags() == EN_PASSANT; }
+	constexpr bool IsCastle() const { return GetFlags() == KING_CASTLE || GetFlags() == QUEEN_CASTLE; }
+
+	// Returns the piece a promotion turns the pawn into. Only valid for promotions.
+	constexpr PieceId GetPromotionPieceId() const
+	{
+		constexpr PieceId promotionPieces[] = { PieceId::KNIGHT, PieceId::BISHOP, PieceId::ROOK, PieceId::QUEEN };
+		return promotionPieces[GetFlags() & 3];
+	}
+
+	// Returns whether both moves go between the same squares, whatever their flags.
+	constexpr bool HasSameSquares(Move other) const { return ((m_data ^ other.m_data) & 0xFFF) == 0; }
+
+	constexpr bool operator==(Move other) const { return m_data == other.m_data; }
+	constexpr bool operator!=(Move other) const { return m_data != other.m_data; }
+
+private:
+	uint16_t m_data;
+};
+
+static_assert(sizeof(Move) == 2, "Move must stay packed in 16 bits");
+static_assert(Move(12, 28, DOUBLE_PAWN_PUSH).GetTo() == 28, "Move encoding is broken");
+
+// Returns the move in coordinate notation, e.g. "e2e4" or "e7e8q".
+inline std::string GetMoveString(Move move)
+{
+	std::string str = {
+		static_cast<char>('a' + FileOf(move.GetFrom())), static_cast<char>('1' + RankOf(move.GetFrom())),
+		static_cast<char>('a' + FileOf(move.GetTo())), static_cast<char>('1' + RankOf(move.GetTo()))
+	};
+	if (move.IsPromotion())
+	{
+		str += GetPieceTypeInfo(move.GetPromotionPieceId()).letter;
+	}
+	return str;
+}
+
+// Fixed capacity list of moves stored inline, so generating moves never touches the heap.
+class MoveList {
+public:
+	// No reachable position has more than 218 legal moves.
+	static constexpr int32_t s_maxMoves = 256;
+
+	void Add(Move move) { m_moves[m_size++] = move; }
+	void Clear() { m_size = 0; }
+
+	int32_t GetSize() const { return m_size; }
+	bool IsEmpty() const { return m_size == 0; }
+
+	Move operator[](int32_t index) const { return m_moves[index]; }
+	Move& operator[](int32_t index) { return m_moves[index]; }
+
+	const Move* begin() const { return m_moves.data(); }
+	const Move* end() const { return m_moves.data() + m_size; }
+
+private:
+	std::array<Move, s_maxMoves> m_moves;
+	int32_t m_size = 0;
+};
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,530 @@
+//---------------------------------------------------------------
+//
+// MoveGen.cpp
+//
+
+#include "MoveGen.h"
+
+#include <algorithm>
+#include <array>
+
+namespace Chess {
+
+//===============================================================================
+
+static void AddMoves(Square from, Bitboard dests, uint16_t flags, MoveList& moves)
+{
+	while (dests)
+	{
+		moves.Add(Move(from, PopLsb(dests), flags));
+	}
+}
+
+// Adds the moves to every destination, flagging the ones that land on an enemy piece as captures.
+static void AddPieceMoves(Square from, Bitboard dests, Bitboard enemy, MoveList& moves)
+{
+	AddMoves(from, dests & enemy, CAPTURE, moves);
+	AddMoves(from, dests & ~enemy, QUIET, moves);
+}
+
+// Returns every square attacked by the given side with the given occupancy.
+static Bitboard GetAttackedSquares(const Position& position, ColorId colorId, Bitboard occupied)
+{
+	Bitboard attacked = GetPawnAttacks(colorId, position.GetPieces(colorId, PieceId::PAWN));
+
+	Bitboard knights = position.GetPieces(colorId, PieceId::KNIGHT);
+	while (knights)
+	{
+		attacked |= GetKnightAttacks(PopLsb(knights));
+	}
+
+	Bitboard diagonals = position.GetPieces(colorId, PieceId::BISHOP) | position.GetPieces(colorId, PieceId::QUEEN);
+	while (diagonals)
+	{
+		attacked |= GetBishopAttacks(PopLsb(diagonals), occupied);
+	}
+
+	Bitboard orthogonals = position.GetPieces(colorId, PieceId::ROOK) | position.GetPieces(colorId, PieceId::QUEEN);
+	while (orthogonals)
+	{
+		attacked |= GetRookAttacks(PopLsb(orthogonals), occupied);
+	}
+
+	Square kingSquare = position.GetKingSquare(colorId);
+	if (kingSquare != s_noSquare)
+	{
+		attacked |= GetKingAttacks(kingSquare);
+	}
+
+	return attacked;
+}
+
+CheckInfo ComputeCheckInfo(const Position& position)
+{
+	return ComputeCheckInfo(position, position.GetSideToMove());
+}
+
+CheckInfo ComputeCheckInfo(const Position& position, ColorId us)
+{
+	CheckInfo checkInfo;
+
+	ColorId them = GetOpponent(us);
+	Square kingSquare = position.GetKingSquare(us);
+	if (kingSquare == s_noSquare)
+	{
+		return checkInfo;
+	}
+
+	Bitboard occupied = position.GetOccupied();
+	Bitboard orthogonals = position.GetPieces(them, PieceId::ROOK) | position.GetPieces(them, PieceId::QUEEN);
+	Bitboard diagonals = position.GetPieces(them, PieceId::BISHOP) | position.GetPieces(them, PieceId::QUEEN);
+
+	checkInfo.kingSquare = kingSquare;
+	checkInfo.checkers = position.AttackersTo(kingSquare, occupied) & position.GetPieces(them);
+
+	// A slider lined up with the king with exactly one friendly piece in between pins that piece.
+	Bitboard snipers = (GetBishopAttacks(kingSquare, 0) & diagonals) | (GetRookAttacks(kingSquare, 0) & orthogonals);
+	while (snipers)
+	{
+		Bitboard blockers = GetBetween(kingSquare, PopLsb(snipers)) & occupied;
+		if (blockers && !(blockers & (blockers - 1)) && (blockers & position.GetPieces(us)))
+		{
+			checkInfo.pinned |= blockers;
+		}
+	}
+
+	if (checkInfo.checkers)
+	{
+		bool isDoubleCheck = (checkInfo.checkers & (checkInfo.checkers - 1)) != 0;
+		checkInfo.checkMask = isDoubleCheck ? 0
+			: GetBetween(kingSquare, GetLsb(checkInfo.checkers)) | checkInfo.checkers;
+	}
+
+	return checkInfo;
+}
+
+// Returns the squares a piece of the given kind on the square attacks. Pawns are handled apart.
+template <PieceId Piece>
+static Bitboard GetPieceAttacks(Square from, Bitboard occupied)
+{
+	if constexpr (Piece == PieceId::KNIGHT) return GetKnightAttacks(from);
+	else if constexpr (Piece == PieceId::BISHOP) return GetBishopAttacks(from, occupied);
+	else if constexpr (Piece == PieceId::ROOK) return GetRookAttacks(from, occupied);
+	else if constexpr (Piece == PieceId::QUEEN) return GetQueenAttacks(from, occupied);
+	else return GetKingAttacks(from);
+}
+
+// Adds a move to every square in the set, coming from Delta squares behind it.
+template <int32_t Delta>
+static void AddShiftedMoves(Bitboard dests, uint16_t flags, MoveList& moves)
+{
+	while (dests)
+	{
+		Square to = PopLsb(dests);
+		moves.Add(Move(to - Delta, to, flags));
+	}
+}
+
+// Per-position state shared by the generators of each piece type.
+struct GenerateContext {
+	const Position& position;
+	const CheckInfo& checkInfo;
+	Bitboard enemy;
+	Bitboard occupied;
+
+	// Pieces to generate moves for.
+	Bitboard sources;
+
+	// Squares a non-king piece may land on: not friendly, resolving a check if there is one,
+	// and holding an enemy piece or not depending on the type of moves wanted.
+	Bitboard targets;
+};
+
+// Adds the legal moves of every piece of the given kind and side. Knights, bishops, rooks and
+// queens only; the step pattern and slider lookup are fixed at compile time.
+template <ColorId Us, PieceId Piece>
+static void Generate(const GenerateContext& context, MoveList& moves)
+{
+	const CheckInfo& checkInfo = context.checkInfo;
+	Bitboard pieces = context.position.GetPieces(Us, Piece) & context.sources;
+
+	// A pinned knight can never stay on the pin line.
+	if constexpr (Piece == PieceId::KNIGHT)
+	{
+		pieces &= ~checkInfo.pinned;
+	}
+
+	while (pieces)
+	{
+		Square from = PopLsb(pieces);
+		Bitboard dests = GetPieceAttacks<Piece>(from, context.occupied) & context.targets;
+
+		// Pinned pieces stay on the line between the king and the pinner.
+		if constexpr (Piece != PieceId::KNIGHT)
+		{
+			if (IsSet(checkInfo.pinned, from))
+			{
+				dests &= GetLine(checkInfo.kingSquare, from);
+			}
+		}
+		AddPieceMoves(from, dests, context.enemy, moves);
+	}
+}
+
+// Adds the four promotions to every square in the set, coming from Delta squares behind it.
+template <int32_t Delta>
+static void AddPromotions(Bitboard dests, bool isCapture, MoveList& moves)
+{
+	uint16_t captureFlag = isCapture ? CAPTURE : QUIET;
+	while (dests)
+	{
+		Square to = PopLsb(dests);
+		Square from = to - Delta;
+		moves.Add(Move(from, to, QUEEN_PROMOTION | captureFlag));
+		moves.Add(Move(from, to, KNIGHT_PROMOTION | captureFlag));
+		moves.Add(Move(from, to, ROOK_PROMOTION | captureFlag));
+		moves.Add(Move(from, to, BISHOP_PROMOTION | captureFlag));
+	}
+}
+
+// Returns whether capturing en passant from the square leaves the king safe. Two pawns leave
+// the rank at once, which pin and check masks cannot describe, so the king is tested directly
+// against the board as it would be after the capture.
+static bool IsLegalEnPassant(const Position& position, const CheckInfo& checkInfo, Square from)
+{
+	if (checkInfo.kingSquare == s_noSquare)
+	{
+		return true;
+	}
+
+	ColorId us = position.GetSideToMove();
+	Square to = position.GetEnPassantSquare();
+	Square capturedSquare = to ^ 8;
+	Bitboard occupied = (position.GetOccupied() ^ SquareBit(from) ^ SquareBit(capturedSquare)) | SquareBit(to);
+	Bitboard attackers = position.AttackersTo(checkInfo.kingSquare, occupied)
+		& position.GetPieces(GetOpponent(us)) & ~SquareBit(capturedSquare);
+	return attackers == 0;
+}
+
+// Adds the pushes, captures and promotions of a set of pawns. Regular moves may only land on
+// the allowed squares. Done for the whole set at once by shifting it, with the directions
+// fixed for the side. Promotions count as captures for the move type, since they change the
+// material balance too.
+template <ColorId Us, MoveGenTypeId Type>
+static void GeneratePawnMoves(const GenerateContext& context, Bitboard pawns, Bitboard allowed, MoveList& moves)
+{
+	constexpr bool isWhite = Us == ColorId::WHITE;
+	constexpr int32_t up = isWhite ? 8 : -8;
+	constexpr int32_t upLeft = isWhite ? 7 : -9;
+	constexpr int32_t upRight = isWhite ? 9 : -7;
+	constexpr Bitboard doublePushRank = isWhite ? s_rank1 << 16 : s_rank1 << 40;
+	constexpr Bitboard promotionRank = isWhite ? s_rank8 : s_rank1;
+
+	Bitboard empty = ~context.occupied;
+	Bitboard push = Shift<up>(pawns) & empty;
+
+	if constexpr (Type != MoveGenTypeId::QUIETS)
+	{
+		Bitboard leftCaptures = Shift<upLeft>(pawns) & context.enemy & allowed;
+		Bitboard rightCaptures = Shift<upRight>(pawns) & context.enemy & allowed;
+		AddShiftedMoves<upLeft>(leftCaptures & ~promotionRank, CAPTURE, moves);
+		AddShiftedMoves<upRight>(rightCaptures & ~promotionRank, CAPTURE, moves);
+		AddPromotions<upLeft>(leftCaptures & promotionRank, true, moves);
+		AddPromotions<upRight>(rightCaptures & promotionRank, true, moves);
+		AddPromotions<up>(push & allowed & promotionRank, false, moves);
+
+		Square enPassantSquare = context.position.GetEnPassantSquare();
+		if (enPassantSquare != s_noSquare)
+		{
+			Bitboard capturers = GetPawnAttacks(GetOpponent(Us), enPassantSquare) & pawns;
+			while (capturers)
+			{
+				Square from = PopLsb(capturers);
+				if (IsLegalEnPassant(context.position, context.checkInfo, from))
+				{
+					moves.Add(Move(from, enPassantSquare, EN_PASSANT));
+				}
+			}
+		}
+	}
+	if constexpr (Type != MoveGenTypeId::CAPTURES)
+	{
+		Bitboard doublePush = Shift<up>(push & doublePushRank) & empty;
+		AddShiftedMoves<up>(push & allowed & ~promotionRank, QUIET, moves);
+		AddShiftedMoves<up + up>(doublePush & allowed, DOUBLE_PAWN_PUSH, moves);
+	}
+}
+
+// Where the king and rook go for one castling move, and which squares must be clear for it.
+struct CastlingPath {
+	CastlingRight right;
+	uint16_t flags;
+	Square kingTo;
+	Square rookFrom;
+
+	// Squares between the king and the rook.
+	Bitboard mustBeEmpty;
+
+	// Squares the king crosses or lands on. It may not be in check to start with either.
+	Bitboard mustBeSafe;
+};
+
+constexpr std::array<std::array<CastlingPath, 2>, s_numColors> s_castlingPaths{{
+	{{
+		{ WHITE_KINGSIDE, KING_CASTLE, MakeSquare(6, 0), MakeSquare(7, 0), 0x60ULL, 0x60ULL },
+		{ WHITE_QUEENSIDE, QUEEN_CASTLE, MakeSquare(2, 0), MakeSquare(0, 0), 0x0EULL, 0x0CULL },
+	}},
+	{{
+		{ BLACK_KINGSIDE, KING_CASTLE, MakeSquare(6, 7), MakeSquare(7, 7), 0x60ULL << 56, 0x60ULL << 56 },
+		{ BLACK_QUEENSIDE, QUEEN_CASTLE, MakeSquare(2, 7), MakeSquare(0, 7), 0x0EULL << 56, 0x0CULL << 56 },
+	}},
+}};
+
+// Adds the legal moves of the given type for the pieces of the side to move in sources.
+template <ColorId Us, MoveGenTypeId Type>
+static void GenerateAll(const Position& position, const CheckInfo& checkInfo, Bitboard sources, MoveList& moves)
+{
+	constexpr ColorId them = GetOpponent(Us);
+	Bitboard own = position.GetPieces(Us);
+	Bitboard enemy = position.GetPieces(them);
+	Bitboard occupied = position.GetOccupied();
+	Square kingSquare = checkInfo.kingSquare;
+
+	Bitboard typeMask = ~0ULL;
+	if constexpr (Type == MoveGenTypeId::CAPTURES)
+	{
+		typeMask = enemy;
+	}
+	else if constexpr (Type == MoveGenTypeId::QUIETS)
+	{
+		typeMask = ~enemy;
+	}
+
+	if (kingSquare != s_noSquare && IsSet(sources, kingSquare))
+	{
+		Bitboard dests = GetKingAttacks(kingSquare) & ~own & typeMask;
+
+		// Rights are cleared whenever the king or rook leaves home, so a right implies both are there.
+		uint8_t castlingRights = 0;
+		if constexpr (Type == MoveGenTypeId::ALL || Type == MoveGenTypeId::QUIETS)
+		{
+			castlingRights = checkInfo.checkers ? 0 : position.GetCastlingRights();
+			for (const CastlingPath& path : s_castlingPaths[ColorIndex(Us)])
+			{
+				if (path.mustBeEmpty & occupied)
+				{
+					castlingRights &= ~path.right;
+				}
+			}
+		}
+
+		if (dests || castlingRights)
+		{
+			// The king is lifted off the board first, so it cannot hide behind itself from a slider.
+			// One attack map for the whole side beats testing each of up to eight squares separately.
+			Bitboard danger = GetAttackedSquares(position, them, occupied ^ SquareBit(kingSquare));
+			AddPieceMoves(kingSquare, dests & ~danger, enemy, moves);
+
+			for (const CastlingPath& path : s_castlingPaths[ColorIndex(Us)])
+			{
+				if ((castlingRights & path.right) && !(path.mustBeSafe & danger))
+				{
+					moves.Add(Move(kingSquare, path.kingTo, path.flags));
+				}
+			}
+		}
+	}
+
+	// In double check only the king can move.
+	if (!checkInfo.checkMask)
+	{
+		return;
+	}
+
+	Bitboard evasionTargets = ~own & checkInfo.checkMask;
+	GenerateContext context{ position, checkInfo, enemy, occupied, sources, evasionTargets & typeMask };
+	Generate<Us, PieceId::KNIGHT>(context, moves);
+	Generate<Us, PieceId::BISHOP>(context, moves);
+	Generate<Us, PieceId::ROOK>(context, moves);
+	Generate<Us, PieceId::QUEEN>(context, moves);
+
+	// Unpinned pawns all move at once; the rare pinned ones one by one along their pin. Pawns
+	// sort out the move type themselves, since a promotion push is not a capture.
+	Bitboard pawns = position.GetPieces(Us, PieceId::PAWN) & sources;
+	GeneratePawnMoves<Us, Type>(context, pawns & ~checkInfo.pinned, evasionTargets, moves);
+	Bitboard pinnedPawns = pawns & checkInfo.pinned;
+	while (pinnedPawns)
+	{
+		Square from = PopLsb(pinnedPawns);
+		GeneratePawnMoves<Us, Type>(context, SquareBit(from), evasionTargets & GetLine(kingSquare, from), moves);
+	}
+}
+
+template <MoveGenTypeId Type>
+static void GenerateForSide(const Position& position, const CheckInfo& checkInfo, Bitboard sources, MoveList& moves)
+{
+	if (position.GetSideToMove() == ColorId::WHITE)
+	{
+		GenerateAll<ColorId::WHITE, Type>(position, checkInfo, sources, moves);
+	}
+	else
+	{
+		GenerateAll<ColorId::BLACK, Type>(position, checkInfo, sources, moves);
+	}
+}
+
+void GenerateLegalMoves(const Position& position, const CheckInfo& checkInfo, MoveList& moves, MoveGenTypeId type)
+{
+	switch (type)
+	{
+	case MoveGenTypeId::CAPTURES:
+		GenerateForSide<MoveGenTypeId::CAPTURES>(position, checkInfo, ~0ULL, moves);
+		break;
+	case MoveGenTypeId::QUIETS:
+		GenerateForSide<MoveGenTypeId::QUIETS>(position, checkInfo, ~0ULL, moves);
+		break;
+	case MoveGenTypeId::EVASIONS:
+		GenerateForSide<MoveGenTypeId::EVASIONS>(position, checkInfo, ~0ULL, moves);
+		break;
+	case MoveGenTypeId::ALL:
+	[[fallthrough]];
+	default:
+		GenerateForSide<MoveGenTypeId::ALL>(position, checkInfo, ~0ULL, moves);
+		break;
+	}
+}
+
+template <ColorId Us>
+static bool HasAnyLegalMoveForSide(const Position& position, const CheckInfo& checkInfo)
+{
+	constexpr ColorId them = GetOpponent(Us);
+	constexpr int32_t up = Us == ColorId::WHITE ? 8 : -8;
+	Bitboard own = position.GetPieces(Us);
+	Bitboard enemy = position.GetPieces(them);
+	Bitboard occupied = position.GetOccupied();
+	Square kingSquare = checkInfo.kingSquare;
+
+	// The king usually has a safe square, and testing squares one by one can stop at the first.
+	if (kingSquare != s_noSquare)
+	{
+		Bitboard occupiedWithoutKing = occupied ^ SquareBit(kingSquare);
+		Bitboard dests = GetKingAttacks(kingSquare) & ~own;
+		while (dests)
+		{
+			if (!(position.AttackersTo(PopLsb(dests), occupiedWithoutKing) & enemy))
+			{
+				return true;
+			}
+		}
+	}
+
+	// In double check only the king can move.
+	if (!checkInfo.checkMask)
+	{
+		return false;
+	}
+
+	Bitboard targets = ~own & checkInfo.checkMask;
+	auto canReach = [&checkInfo, kingSquare, targets](Square from, Bitboard attacks)
+	{
+		Bitboard dests = attacks & targets;
+		if (IsSet(checkInfo.pinned, from))
+		{
+			dests &= GetLine(kingSquare, from);
+		}
+		return dests != 0;
+	};
+
+	Bitboard pawns = position.GetPieces(Us, PieceId::PAWN);
+	Bitboard empty = ~occupied;
+	Bitboard unpinnedPawns = pawns & ~checkInfo.pinned;
+	constexpr Bitboard doublePushRank = Us == ColorId::WHITE ? s_rank1 << 16 : s_rank1 << 40;
+	Bitboard push = Shift<up>(unpinnedPawns) & empty;
+	if ((push | (Shift<up>(push & doublePushRank) & empty) | (GetPawnAttacks(Us, unpinnedPawns) & enemy)) & targets)
+	{
+		return true;
+	}
+
+	Bitboard knights = position.GetPieces(Us, PieceId::KNIGHT) & ~checkInfo.pinned;
+	while (knights)
+	{
+		if (GetKnightAttacks(PopLsb(knights)) & targets)
+		{
+			return true;
+		}
+	}
+
+	Bitboard diagonals = position.GetPieces(Us, PieceId::BISHOP) | position.GetPieces(Us, PieceId::QUEEN);
+	while (diagonals)
+	{
+		Square from = PopLsb(diagonals);
+		if (canReach(from, GetBishopAttacks(from, occupied)))
+		{
+			return true;
+		}
+	}
+
+	Bitboard orthogonals = position.GetPieces(Us, PieceId::ROOK) | position.GetPieces(Us, PieceId::QUEEN);
+	while (orthogonals)
+	{
+		Square from = PopLsb(orthogonals);
+		if (canReach(from, GetRookAttacks(from, occupied)))
+		{
+			return true;
+		}
+	}
+
+	Bitboard pinnedPawns = pawns & checkInfo.pinned;
+	while (pinnedPawns)
+	{
+		Square from = PopLsb(pinnedPawns);
+		Bitboard pawn = SquareBit(from);
+		Bitboard pinnedPush = Shift<up>(pawn) & empty;
+		Bitboard attacks = pinnedPush | (Shift<up>(pinnedPush & doublePushRank) & empty)
+			| (GetPawnAttacks(Us, from) & enemy);
+		if (canReach(from, attacks))
+		{
+			return true;
+		}
+	}
+
+	// Castling never needs a look: if it is legal, so is the king's single step toward the rook.
+	// En passant can be the only legal move, though, so it has to be tried.
+	Square enPassantSquare = position.GetEnPassantSquare();
+	if (enPassantSquare != s_noSquare)
+	{
+		Bitboard capturers = GetPawnAttacks(them, enPassantSquare) & pawns;
+		while (capturers)
+		{
+			if (IsLegalEnPassant(position, checkInfo, PopLsb(capturers)))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool HasAnyLegalMove(const Position& position, const CheckInfo& checkInfo)
+{
+	return position.GetSideToMove() == ColorId::WHITE
+		? HasAnyLegalMoveForSide<ColorId::WHITE>(position, checkInfo)
+		: HasAnyLegalMoveForSide<ColorId::BLACK>(position, checkInfo);
+}
+
+bool IsLegalMove(const Position& position, const CheckInfo& checkInfo, Move move)
+{
+	if (move == Move::None() || position.GetColorAt(move.GetFrom()) != position.GetSideToMove())
+	{
+		return false;
+	}
+
+	MoveList moves;
+	GenerateForSide<MoveGenTypeId::ALL>(position, checkInfo, SquareBit(move.GetFrom()), moves);
+	return std::find(moves.begin(), moves.end(), move) != moves.end();
+}
+
+//===============================================================================
+
+} // namespace Chess
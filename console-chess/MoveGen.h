@@ -0,0 +1,67 @@
+//---------------------------------------------------------------
+//
+// MoveGen.h
+//
+
+#pragma once
+
+#include "Move.h"
+#include "Position.h"
+
+namespace Chess {
+
+//===============================================================================
+
+// Check and pin state of the side to move, computed once per position.
+struct CheckInfo {
+	// Square of the king of the side to move, or s_noSquare if it has none.
+	Square kingSquare = s_noSquare;
+
+	// Enemy pieces giving check.
+	Bitboard checkers = 0;
+
+	// Friendly pieces that shield the king from an enemy slider. They may only move along the pin.
+	Bitboard pinned = 0;
+
+	// Squares a piece other than the king must move to: everything when not in check, the
+	// checker and the squares between it and the king when in single check, nothing in double check.
+	Bitboard checkMask = ~0ULL;
+};
+
+// Which moves a generator call produces.
+enum struct MoveGenTypeId : uint32_t {
+	ALL = 0,
+
+	// Moves that capture a piece or promote a pawn.
+	CAPTURES,
+
+	// Every other move, castling included.
+	QUIETS,
+
+	// Every move out of check. Only valid when the side to move is in check; skips castling
+	// and, in double check, everything but the king.
+	EVASIONS
+};
+
+// Returns the check and pin state of the side to move.
+CheckInfo ComputeCheckInfo(const Position& position);
+
+// Returns the check and pin state of the given side, as if it were to move.
+CheckInfo ComputeCheckInfo(const Position& position, ColorId colorId);
+
+// Appends every legal move of the given type for the side to move. No move has to be tried on
+// the board.
+void GenerateLegalMoves(const Position& position, const CheckInfo& checkInfo, MoveList& moves,
+	MoveGenTypeId type = MoveGenTypeId::ALL);
+
+// Returns whether the side to move has at least one legal move. Stops at the first one found,
+// trying king moves first, and never builds a move list. Use it to detect mate and stalemate.
+bool HasAnyLegalMove(const Position& position, const CheckInfo& checkInfo);
+
+// Returns whether the move, flags included, is legal in the position. Only generates the moves
+// of the piece on the move's from square, so it is cheap enough to vet a move from a table.
+bool IsLegalMove(const Position& position, const CheckInfo& checkInfo, Move move);
+
+//===============================================================================
+
+} // namespace Chess
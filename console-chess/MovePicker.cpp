@@ -0,0 +1,251 @@
+//---------------------------------------------------------------
+//
+// MovePicker.cpp
+//
+
+#include "MovePicker.h"
+
+#include "Evaluate.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Chess {
+
+//===============================================================================
+
+// Orders captures most valuable victim first, then least valuable attacker first. A promotion
+// counts the new piece as if it were captured too.
+static int32_t GetCaptureScore(const Position& position, Move move)
+{
+	int32_t gain = 0;
+	if (move.IsCapture())
+	{
+		PieceId victimId = move.IsEnPassant() ? PieceId::PAWN : position.GetPieceIdAt(move.GetTo());
+		gain += GetPieceTypeInfo(victimId).points;
+	}
+	if (move.IsPromotion())
+	{
+		gain += GetPieceTypeInfo(move.GetPromotionPieceId()).points;
+	}
+
+	// One point more of gain always outweighs the whole range of attackers.
+	int32_t attacker = GetPieceTypeInfo(position.GetPieceIdAt(move.GetFrom())).points;
+	return gain * 16 - attacker;
+}
+
+// Returns whether a capture or promotion loses material once the exchange on its to square is
+// played out. Taking a piece worth at least the one taking it never does, whatever follows.
+static bool IsLosingCapture(const Position& position, Move move)
+{
+	if (!move.IsPromotion())
+	{
+		PieceId victimId = move.IsEnPassant() ? PieceId::PAWN : position.GetPieceIdAt(move.GetTo());
+		if (GetPieceTypeInfo(victimId).points >= GetPieceTypeInfo(position.GetPieceIdAt(move.GetFrom())).points)
+		{
+			return false;
+		}
+	}
+	return EvaluateExchange(position, move) < 0;
+}
+
+// Puts every capture ahead of every quiet move, whatever its history.
+static const int32_t s_evasionCaptureBonus = 1 << 20;
+
+MovePicker::MovePicker(const Position& position, const CheckInfo& checkInfo, Move hashMove,
+	Move killer1, Move killer2, Move countermove, const HistoryTable* history)
+	: m_position(position)
+	, m_checkInfo(checkInfo)
+	, m_history(history)
+	, m_hashMove(hashMove)
+	, m_refutations{{ killer1, killer2, countermove }}
+{
+	// Captures and promotions are tried in their own stage, so such a refutation adds nothing,
+	// and neither does one that repeats an earlier one.
+	for (int32_t i = 0; i < static_cast<int32_t>(m_refutations.size()); ++i)
+	{
+		Move& refutation = m_refutations[i];
+		if (refutation.IsCapture() || refutation.IsPromotion()
+			|| std::find(m_refutations.begin(), m_refutations.begin() + i, refutation) != m_refutations.begin() + i)
+		{
+			refutation = Move::None();
+		}
+	}
+}
+
+MovePicker::MovePicker(const Position& position, const CheckInfo& checkInfo, const HistoryTable* history)
+	: m_position(position)
+	, m_checkInfo(checkInfo)
+	, m_history(history)
+	, m_hashMove(Move::None())
+	, m_isQuiescence(true)
+	, m_refutations{{ Move::None(), Move::None(), Move::None() }}
+{
+	m_stage = checkInfo.checkers ? StageId::GENERATE_EVASIONS : StageId::GENERATE_CAPTURES;
+}
+
+Move MovePicker::GetNextMove()
+{
+	for (;;)
+	{
+		switch (m_stage)
+		{
+		case StageId::HASH_MOVE:
+			m_stage = m_checkInfo.checkers ? StageId::GENERATE_EVASIONS : StageId::GENERATE_CAPTURES;
+			if (IsLegalMove(m_position, m_checkInfo, m_hashMove))
+			{
+				return m_hashMove;
+			}
+			break;
+
+		case StageId::GENERATE_CAPTURES:
+			GenerateLegalMoves(m_position, m_checkInfo, m_moves, MoveGenTypeId::CAPTURES);
+			for (int32_t i = 0; i < m_moves.GetSize(); ++i)
+			{
+				m_scores[i] = GetCaptureScore(m_position, m_moves[i]);
+			}
+			m_index = 0;
+			m_stage = StageId::CAPTURES;
+			break;
+
+		case StageId::CAPTURES:
+			while (m_index < m_moves.GetSize())
+			{
+				Move move = PickBest();
+				if (IsAlreadyReturned(move))
+				{
+					continue;
+				}
+
+				// Quiescence search drops losing captures altogether.
+				if (IsLosingCapture(m_position, move))
+				{
+					if (!m_isQuiescence)
+					{
+						m_badCaptures.Add(move);
+					}
+					continue;
+				}
+				return move;
+			}
+			m_stage = m_isQuiescence ? StageId::DONE : StageId::REFUTATIONS;
+			break;
+
+		case StageId::REFUTATIONS:
+			while (m_refutationIndex < static_cast<int32_t>(m_refutations.size()))
+			{
+				Move refutation = m_refutations[m_refutationIndex++];
+				if (refutation != m_hashMove && IsLegalMove(m_position, m_checkInfo, refutation))
+				{
+					return refutation;
+				}
+			}
+			m_stage = StageId::GENERATE_QUIETS;
+			break;
+
+		case StageId::GENERATE_QUIETS:
+			m_moves.Clear();
+			GenerateLegalMoves(m_position, m_checkInfo, m_moves, MoveGenTypeId::QUIETS);
+			if (m_history)
+			{
+				const auto& sideHistory = (*m_history)[ColorIndex(m_position.GetSideToMove())];
+				for (int32_t i = 0; i < m_moves.GetSize(); ++i)
+				{
+					m_scores[i] = sideHistory[m_moves[i].GetFrom()][m_moves[i].GetTo()];
+				}
+			}
+			m_index = 0;
+			m_stage = StageId::QUIETS;
+			break;
+
+		case StageId::QUIETS:
+			while (m_index < m_moves.GetSize())
+			{
+				Move move = m_history ? PickBest() : m_moves[m_index++];
+				if (!IsAlreadyReturned(move))
+				{
+					return move;
+				}
+			}
+			m_stage = StageId::BAD_CAPTURES;
+			break;
+
+		case StageId::BAD_CAPTURES:
+			if (m_badCaptureIndex < m_badCaptures.GetSize())
+			{
+				return m_badCaptures[m_badCaptureIndex++];
+			}
+			m_stage = StageId::DONE;
+			break;
+
+		case StageId::GENERATE_EVASIONS:
+			GenerateLegalMoves(m_position, m_checkInfo, m_moves, MoveGenTypeId::EVASIONS);
+			for (int32_t i = 0; i < m_moves.GetSize(); ++i)
+			{
+				m_scores[i] = GetEvasionScore(m_moves[i]);
+			}
+			m_index = 0;
+			m_stage = StageId::EVASIONS;
+			break;
+
+		case StageId::EVASIONS:
+			while (m_index < m_moves.GetSize())
+			{
+				Move move = PickBest();
+				if (move != m_hashMove)
+				{
+					return move;
+				}
+			}
+			m_stage = StageId::DONE;
+			break;
+
+		case StageId::DONE:
+		[[fallthrough]];
+		default:
+			return Move::None();
+		}
+	}
+}
+
+int32_t MovePicker::GetEvasionScore(Move move) const
+{
+	if (move.IsCapture() || move.IsPromotion())
+	{
+		return s_evasionCaptureBonus + GetCaptureScore(m_position, move);
+	}
+	if (m_history)
+	{
+		return (*m_history)[ColorIndex(m_position.GetSideToMove())][move.GetFrom()][move.GetTo()];
+	}
+	return 0;
+}
+
+Move MovePicker::PickBest()
+{
+	// Selection sort one step at a time: most nodes cut off after a move or two, so sorting
+	// the whole list up front would be wasted.
+	int32_t best = m_index;
+	for (int32_t i = m_index + 1; i < m_moves.GetSize(); ++i)
+	{
+		if (m_scores[i] > m_scores[best])
+		{
+			best = i;
+		}
+	}
+	std::swap(m_moves[best], m_moves[m_index]);
+	std::swap(m_scores[best], m_scores[m_index]);
+	return m_moves[m_index++];
+}
+
+bool MovePicker::IsAlreadyReturned(Move move) const
+{
+	// A hash move or refutation that was not legal cannot match a generated move, so there is
+	// no need to remember which of them were actually returned.
+	return move == m_hashMove
+		|| std::find(m_refutations.begin(), m_refutations.end(), move) != m_refutations.end();
+}
+
+//===============================================================================
+
+} // namespace Chess
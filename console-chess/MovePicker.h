@@ -0,0 +1,94 @@
+//---------------------------------------------------------------
+//
+// MovePicker.h
+//
+
+#pragma once
+
+#include "MoveGen.h"
+
+#include <array>
+
+namespace Chess {
+
+//===============================================================================
+
+// How well each quiet move has done in the search so far, by side to move, from square and to
+// square. Cutoffs raise a score, quiet moves tried before a cutoff lower it.
+using HistoryTable = std::array<std::array<std::array<int32_t, s_numSquares>, s_numSquares>, s_numColors>;
+
+// Scores in a HistoryTable stay within plus or minus this.
+constexpr int32_t s_maxHistoryScore = 1 << 14;
+
+// Hands out the legal moves of a position one at a time, best guesses first, generating each
+// group only when the previous one is used up. A search that cuts off early never pays for
+// the later groups: the hash move is tried before anything is generated, and quiet moves are
+// not generated until every capture, promotion, killer and the countermove has been tried.
+// Captures go most valuable victim, least valuable attacker first; quiet moves by history.
+// A capture that loses material by static exchange evaluation is held back until after the
+// quiet moves. In check every evasion is generated at once instead, captures first.
+class MovePicker {
+public:
+	// The hash move, killers and countermove may be Move::None() or moves from another
+	// position; they are checked for legality before being handed out. Killers and the
+	// countermove are only used if they are quiet and not promotions. Without a history table
+	// quiet moves come in generation order.
+	MovePicker(const Position& position, const CheckInfo& checkInfo, Move hashMove,
+		Move killer1 = Move::None(), Move killer2 = Move::None(), Move countermove = Move::None(),
+		const HistoryTable* history = nullptr);
+
+	// For quiescence search: only the captures and promotions that do not lose material, or
+	// every evasion when in check.
+	MovePicker(const Position& position, const CheckInfo& checkInfo, const HistoryTable* history = nullptr);
+
+	// Returns the next move to try, or Move::None() once every legal move has been returned.
+	// Each legal move is returned exactly once.
+	Move GetNextMove();
+
+private:
+	enum struct StageId : uint32_t {
+		HASH_MOVE = 0,
+		GENERATE_CAPTURES,
+		CAPTURES,
+		REFUTATIONS,
+		GENERATE_QUIETS,
+		QUIETS,
+		BAD_CAPTURES,
+		GENERATE_EVASIONS,
+		EVASIONS,
+		DONE
+	};
+
+	// Returns the order of an evasion: captures by victim and attacker, then quiet moves by history.
+	int32_t GetEvasionScore(Move move) const;
+
+	// Moves the best scored move left in the list to the current index and returns it.
+	Move PickBest();
+
+	// Returns whether a move was already returned by an earlier stage.
+	bool IsAlreadyReturned(Move move) const;
+
+private:
+	const Position& m_position;
+	const CheckInfo& m_checkInfo;
+	const HistoryTable* m_history;
+	Move m_hashMove;
+	bool m_isQuiescence = false;
+
+	// The two killers, then the countermove.
+	std::array<Move, 3> m_refutations;
+
+	StageId m_stage = StageId::HASH_MOVE;
+	MoveList m_moves;
+	std::array<int32_t, MoveList::s_maxMoves> m_scores;
+	int32_t m_index = 0;
+
+	// Captures that lose material, in the order they were held back.
+	MoveList m_badCaptures;
+	int32_t m_badCaptureIndex = 0;
+	int32_t m_refutationIndex = 0;
+};
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,286 @@
+//---------------------------------------------------------------
+//
+// Perft.cpp
+//
+
+#include "Perft.h"
+#include "HashEntry.h"
+#include "MoveGen.h"
+#include "ThreadPool.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace Chess {
+
+//===============================================================================
+
+struct PerftCase {
+	const char* name;
+	const char* fen;
+	int32_t depth;
+	uint64_t expectedNodes;
+};
+
+// Standard test positions and their node counts, as published on the Chess Programming Wiki.
+// Between them they cover castling, en passant, promotions, pins and discovered checks.
+static const std::array<PerftCase, 6> s_perftSuite{{
+	{ "start", s_startFen, 5, 4865609 },
+	{ "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603 },
+	{ "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+	{ "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+	{ "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487 },
+	{ "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594 },
+}};
+
+// Root subtrees at least this deep are split into one task per reply, so that there are
+// enough tasks to keep every thread busy and to balance uneven subtrees by stealing.
+static const int32_t s_minSplitDepth = 4;
+
+using PerftClock = std::chrono::steady_clock;
+
+// Subtree node counts keyed by position hash and depth, shared by every thread without locks
+// through HashEntry.
+class PerftTable {
+public:
+	explicit PerftTable(std::size_t megabytes)
+		: m_size(GetHashTableSize(megabytes, sizeof(HashEntry)))
+		, m_entries(new HashEntry[m_size])
+	{
+	}
+
+	bool Probe(uint64_t hash, int32_t depth, uint64_t& nodes) const
+	{
+		uint64_t data = 0;
+		if (!m_entries[hash & (m_size - 1)].Load(hash, data) || static_cast<int32_t>(data >> s_depthShift) != depth)
+		{
+			return false;
+		}
+		nodes = data & s_nodesMask;
+		return true;
+	}
+
+	void Store(uint64_t hash, int32_t depth, uint64_t nodes)
+	{
+		m_entries[hash & (m_size - 1)].Save(hash, (static_cast<uint64_t>(depth) << s_depthShift) | (nodes & s_nodesMask));
+	}
+
+private:
+	// Depth in the top byte, the node count below it.
+	static const int32_t s_depthShift = 56;
+	static const uint64_t s_nodesMask = (1ULL << s_depthShift) - 1;
+
+	std::size_t m_size = 0;
+	std::unique_ptr<HashEntry[]> m_entries;
+};
+
+// Returns the nodes per second for a run, rounding a zero duration up to avoid dividing by it.
+static uint64_t GetNodesPerSecond(uint64_t nodes, PerftClock::duration elapsed)
+{
+	auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	return nodes * 1000000 / static_cast<uint64_t>(micros > 0 ? micros : 1);
+}
+
+uint64_t Perft(Position& position, int32_t depth)
+{
+	if (depth <= 0)
+	{
+		return 1;
+	}
+
+	MoveList moves;
+	GenerateLegalMoves(position, ComputeCheckInfo(position), moves);
+
+	// Every generated move is legal, so the last ply only needs counting.
+	if (depth == 1)
+	{
+		return static_cast<uint64_t>(moves.GetSize());
+	}
+
+	uint64_t nodes = 0;
+	for (Move move : moves)
+	{
+		UndoInfo undo;
+		position.MakeMove(move, undo);
+		nodes += Perft(position, depth - 1);
+		position.UnmakeMove(move, undo);
+	}
+	return nodes;
+}
+
+// Perft that looks subtrees up in the table before searching them. Depth 1 is cheaper to
+// count than to look up, so only deeper subtrees are cached.
+static uint64_t HashedPerft(Position& position, int32_t depth, PerftTable& table)
+{
+	if (depth <= 1)
+	{
+		return Perft(position, depth);
+	}
+
+	uint64_t hash = position.GetHash();
+	uint64_t nodes = 0;
+	if (table.Probe(hash, depth, nodes))
+	{
+		return nodes;
+	}
+
+	MoveList moves;
+	GenerateLegalMoves(position, ComputeCheckInfo(position), moves);
+	for (Move move : moves)
+	{
+		UndoInfo undo;
+		position.MakeMove(move, undo);
+		nodes += HashedPerft(position, depth - 1, table);
+		position.UnmakeMove(move, undo);
+	}
+
+	table.Store(hash, depth, nodes);
+	return nodes;
+}
+
+static uint64_t SearchSubtree(Position& position, int32_t depth, PerftTable* table)
+{
+	return table ? HashedPerft(position, depth, *table) : Perft(position, depth);
+}
+
+// Searches the subtree below the position on the pool, adding its node count to nodes.
+// Deep subtrees are split into one task per reply, which may be stolen by idle workers.
+static void SubmitSubtree(ThreadPool& pool, const Position& position, int32_t depth,
+	PerftTable* table, std::atomic<uint64_t>& nodes)
+{
+	// Each task owns a copy of its position, which is cheap since Position is a flat struct.
+	pool.Submit([&pool, subtree = position, depth, table, &nodes]() mutable
+	{
+		if (depth < s_minSplitDepth)
+		{
+			nodes += SearchSubtree(subtree, depth, table);
+			return;
+		}
+
+		MoveList moves;
+		GenerateLegalMoves(subtree, ComputeCheckInfo(subtree), moves);
+		for (Move move : moves)
+		{
+			UndoInfo undo;
+			subtree.MakeMove(move, undo);
+			SubmitSubtree(pool, subtree, depth - 1, table, nodes);
+			subtree.UnmakeMove(move, undo);
+		}
+	});
+}
+
+// Returns the node count below each legal root move, in generation order.
+static std::vector<uint64_t> CountRootMoves(const Position& rootPosition, int32_t depth,
+	const PerftOptions& options, MoveList& rootMoves)
+{
+	Position position = rootPosition;
+	GenerateLegalMoves(position, ComputeCheckInfo(position), rootMoves);
+
+	std::unique_ptr<PerftTable> table;
+	if (options.hashMegabytes > 0)
+	{
+		table = std::make_unique<PerftTable>(options.hashMegabytes);
+	}
+
+	std::vector<uint64_t> counts(rootMoves.GetSize());
+	if (options.numThreads == 1)
+	{
+		for (int32_t i = 0; i < rootMoves.GetSize(); ++i)
+		{
+			UndoInfo undo;
+			position.MakeMove(rootMoves[i], undo);
+			counts[i] = SearchSubtree(position, depth - 1, table.get());
+			position.UnmakeMove(rootMoves[i], undo);
+		}
+		return counts;
+	}
+
+	std::vector<std::atomic<uint64_t>> atomicCounts(rootMoves.GetSize());
+	{
+		ThreadPool pool(options.numThreads);
+		for (int32_t i = 0; i < rootMoves.GetSize(); ++i)
+		{
+			UndoInfo undo;
+			position.MakeMove(rootMoves[i], undo);
+			SubmitSubtree(pool, position, depth - 1, table.get(), atomicCounts[i]);
+			position.UnmakeMove(rootMoves[i], undo);
+		}
+		pool.WaitIdle();
+	}
+
+	for (int32_t i = 0; i < rootMoves.GetSize(); ++i)
+	{
+		counts[i] = atomicCounts[i];
+	}
+	return counts;
+}
+
+uint64_t PerftDivide(const Position& position, int32_t depth, const PerftOptions& options, std::ostream& out)
+{
+	auto start = PerftClock::now();
+
+	MoveList moves;
+	std::vector<uint64_t> counts = CountRootMoves(position, depth, options, moves);
+
+	auto elapsed = PerftClock::now() - start;
+
+	uint64_t nodes = 0;
+	for (int32_t i = 0; i < moves.GetSize(); ++i)
+	{
+		out << GetMoveString(moves[i]) << ": " << counts[i] << "\n";
+		nodes += counts[i];
+	}
+
+	out << "\nNodes: " << nodes << "\n";
+	out << "Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms\n";
+	out << "NPS: " << GetNodesPerSecond(nodes, elapsed) << "\n";
+	return nodes;
+}
+
+bool RunPerftSuite(const PerftOptions& options, std::ostream& out)
+{
+	bool allPassed = true;
+	uint64_t totalNodes = 0;
+	PerftClock::duration totalElapsed{};
+
+	for (const PerftCase& perftCase : s_perftSuite)
+	{
+		Position position;
+		position.SetFromFen(perftCase.fen);
+
+		auto start = PerftClock::now();
+		MoveList moves;
+		uint64_t nodes = 0;
+		for (uint64_t count : CountRootMoves(position, perftCase.depth, options, moves))
+		{
+			nodes += count;
+		}
+		auto elapsed = PerftClock::now() - start;
+
+		bool passed = nodes == perftCase.expectedNodes;
+		allPassed = allPassed && passed;
+		totalNodes += nodes;
+		totalElapsed += elapsed;
+
+		out << (passed ? "ok   " : "FAIL ") << perftCase.name << " depth " << perftCase.depth
+			<< ": " << nodes;
+		if (!passed)
+		{
+			out << " (expected " << perftCase.expectedNodes << ")";
+		}
+		out << ", " << GetNodesPerSecond(nodes, elapsed) << " nps\n";
+	}
+
+	out << "\nTotal nodes: " << totalNodes << "\n";
+	out << "Time: " << std::chrono::duration_cast<std::chrono::milliseconds>(totalElapsed).count() << " ms\n";
+	out << "NPS: " << GetNodesPerSecond(totalNodes, totalElapsed) << "\n";
+	return allPassed;
+}
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,41 @@
+//---------------------------------------------------------------
+//
+// Perft.h
+//
+
+#pragma once
+
+#include "Position.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Chess {
+
+//===============================================================================
+
+// How a perft run is spread over threads and cached.
+struct PerftOptions {
+	// Number of threads to search with. 1 searches on the calling thread, 0 uses every hardware thread.
+	int32_t numThreads = 1;
+
+	// Size of the shared subtree count cache in megabytes. 0 disables it.
+	std::size_t hashMegabytes = 0;
+};
+
+// Returns the number of leaf nodes of the legal move tree below the position at the given
+// depth. The position is restored before returning.
+uint64_t Perft(Position& position, int32_t depth);
+
+// Prints the perft node count under each legal root move, then the total and the speed.
+// Returns the total.
+uint64_t PerftDivide(const Position& position, int32_t depth, const PerftOptions& options, std::ostream& out);
+
+// Runs perft over a fixed set of positions with published node counts and prints each result.
+// Returns whether every count matched.
+bool RunPerftSuite(const PerftOptions& options, std::ostream& out);
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,414 @@
+//---------------------------------------------------------------
+//
+// Position.cpp
+//
+
+#include "Position.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cctype>
+#include <initializer_list>
+#include <sstream>
+
+namespace Chess {
+
+//===============================================================================
+
+// Castling rights that survive a move touching each square. Moving a king or rook off its home
+// square, or capturing a rook on it, clears the matching rights.
+static const std::array<uint8_t, s_numSquares> s_castlingRightsMask = [] {
+	std::array<uint8_t, s_numSquares> mask{};
+	mask.fill(ALL_CASTLING);
+	mask[MakeSquare(0, 0)] &= ~WHITE_QUEENSIDE;
+	mask[MakeSquare(7, 0)] &= ~WHITE_KINGSIDE;
+	mask[MakeSquare(4, 0)] &= ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);
+	mask[MakeSquare(0, 7)] &= ~BLACK_QUEENSIDE;
+	mask[MakeSquare(7, 7)] &= ~BLACK_KINGSIDE;
+	mask[MakeSquare(4, 7)] &= ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+	return mask;
+}();
+
+// Where the king and rook of each castling right start out.
+struct CastlingHome {
+	CastlingRight right;
+	ColorId colorId;
+	Square kingSquare;
+	Square rookSquare;
+};
+
+static const std::array<CastlingHome, 4> s_castlingHomes{{
+	{ WHITE_KINGSIDE, ColorId::WHITE, MakeSquare(4, 0), MakeSquare(7, 0) },
+	{ WHITE_QUEENSIDE, ColorId::WHITE, MakeSquare(4, 0), MakeSquare(0, 0) },
+	{ BLACK_KINGSIDE, ColorId::BLACK, MakeSquare(4, 7), MakeSquare(7, 7) },
+	{ BLACK_QUEENSIDE, ColorId::BLACK, MakeSquare(4, 7), MakeSquare(0, 7) },
+}};
+
+void Position::Clear()
+{
+	*this = Position{};
+}
+
+bool Position::SetFromFen(const std::string& fen)
+{
+	Clear();
+
+	std::istringstream iss(fen);
+	std::string placement;
+	std::string sideToMove;
+	std::string castling;
+	std::string enPassant;
+	if (!(iss >> placement >> sideToMove >> castling >> enPassant))
+	{
+		return false;
+	}
+
+	// Placement runs from rank 8 down to rank 1, a file to h file within each rank.
+	int32_t file = 0;
+	int32_t rank = 7;
+	for (char c : placement)
+	{
+		if (c == '/')
+		{
+			if (file != 8 || rank == 0)
+			{
+				Clear();
+				return false;
+			}
+			file = 0;
+			--rank;
+			continue;
+		}
+
+		if (c >= '1' && c <= '8')
+		{
+			file += c - '0';
+		}
+		else
+		{
+			PieceId pieceId = GetPieceIdFromLetter(c);
+			if (pieceId == PieceId::EMPTY || file >= 8)
+			{
+				Clear();
+				return false;
+			}
+			PutPiece(MakeSquare(file, rank), pieceId, std::isupper(c) ? ColorId::WHITE : ColorId::BLACK);
+			++file;
+		}
+
+		if (file > 8)
+		{
+			Clear();
+			return false;
+		}
+	}
+	if (file != 8 || rank != 0)
+	{
+		Clear();
+		return false;
+	}
+
+	// Search and move generation rely on each side having exactly one king, and a pawn on
+	// the first or last rank could never have got there.
+	if (PopCount(GetPieces(ColorId::WHITE, PieceId::KING)) != 1 || PopCount(GetPieces(ColorId::BLACK, PieceId::KING)) != 1
+		|| ((GetPieces(ColorId::WHITE, PieceId::PAWN) | GetPieces(ColorId::BLACK, PieceId::PAWN)) & (s_rank1 | s_rank8)))
+	{
+		Clear();
+		return false;
+	}
+
+	if (sideToMove != "w" && sideToMove != "b")
+	{
+		Clear();
+		return false;
+	}
+	m_sideToMove = sideToMove == "w" ? ColorId::WHITE : ColorId::BLACK;
+
+	// The side that just moved cannot have left its king in check.
+	const ColorId justMoved = GetOpponent(m_sideToMove);
+	if (IsSquareAttacked(GetKingSquare(justMoved), m_sideToMove))
+	{
+		Clear();
+		return false;
+	}
+
+	if (castling != "-")
+	{
+		for (char c : castling)
+		{
+			switch (c)
+			{
+			case 'K': m_castlingRights |= WHITE_KINGSIDE; break;
+			case 'Q': m_castlingRights |= WHITE_QUEENSIDE; break;
+			case 'k': m_castlingRights |= BLACK_KINGSIDE; break;
+			case 'q': m_castlingRights |= BLACK_QUEENSIDE; break;
+			default:
+				Clear();
+				return false;
+			}
+		}
+	}
+
+	// A right is only kept while its king and rook are on their home squares; otherwise
+	// castling would move a rook that is not there.
+	for (const CastlingHome& home : s_castlingHomes)
+	{
+		if (GetPieceAt(home.kingSquare) != MakePiece(home.colorId, PieceId::KING)
+			|| GetPieceAt(home.rookSquare) != MakePiece(home.colorId, PieceId::ROOK))
+		{
+			m_castlingRights &= ~home.right;
+		}
+	}
+
+	if (enPassant != "-")
+	{
+		// The square is the one the opponent's pawn just skipped: on rank 6 with white to move,
+		// rank 3 with black to move, with the pawn right past it and both squares it crossed empty.
+		const ColorId them = GetOpponent(m_sideToMove);
+		const char skippedRank = m_sideToMove == ColorId::WHITE ? '6' : '3';
+		if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] != skippedRank)
+		{
+			Clear();
+			return false;
+		}
+
+		Square skipped = MakeSquare(enPassant[0] - 'a', enPassant[1] - '1');
+		Square pawnSquare = them == ColorId::WHITE ? skipped + 8 : skipped - 8;
+		Square startSquare = them == ColorId::WHITE ? skipped - 8 : skipped + 8;
+		if (GetPieceAt(pawnSquare) != MakePiece(them, PieceId::PAWN)
+			|| GetPieceAt(skipped) != s_noPiece || GetPieceAt(startSquare) != s_noPiece)
+		{
+			Clear();
+			return false;
+		}
+
+		// As in MakeMove, the square is only kept if a pawn can take on it, so that the hash
+		// matches the same position reached by playing the moves.
+		if (GetPawnAttacks(them, skipped) & GetPieces(m_sideToMove, PieceId::PAWN))
+		{
+			m_enPassantSquare = skipped;
+		}
+	}
+
+	// The halfmove clock is optional; a missing one reads as zero. It has to fit the 16 bits
+	// UndoInfo keeps of it.
+	std::string halfmoveClock;
+	if (iss >> halfmoveClock)
+	{
+		if (halfmoveClock.size() > 5 || !std::all_of(halfmoveClock.begin(), halfmoveClock.end(),
+			[](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; })
+			|| std::stoi(halfmoveClock) > UINT16_MAX)
+		{
+			Clear();
+			return false;
+		}
+		m_halfmoveClock = std::stoi(halfmoveClock);
+	}
+
+	// The pieces were hashed as they were placed; the rest of the state was set directly.
+	m_hash = ComputeHash();
+	return true;
+}
+
+// Returns where the rook starts and ends for a castling move, given the king's destination.
+static void GetCastlingRookSquares(Move move, Square& rookFrom, Square& rookTo)
+{
+	Square kingTo = move.GetTo();
+	bool isKingside = move.GetFlags() == KING_CASTLE;
+	rookFrom = isKingside ? kingTo + 1 : kingTo - 2;
+	rookTo = isKingside ? kingTo - 1 : kingTo + 1;
+}
+
+void Position::MakeMove(Move move, UndoInfo& undo)
+{
+	Square from = move.GetFrom();
+	Square to = move.GetTo();
+	PieceId pieceId = GetPieceIdAt(from);
+	ColorId colorId = m_sideToMove;
+	ColorId opponentId = GetOpponent(colorId);
+
+	// En passant is the one capture where the captured piece is not on the destination.
+	Square capturedSquare = move.IsEnPassant() ? to ^ 8 : to;
+
+	undo.capturedPieceId = move.IsCapture() ? GetPieceIdAt(capturedSquare) : PieceId::EMPTY;
+	undo.castlingRights = m_castlingRights;
+	undo.enPassantSquare = static_cast<uint8_t>(m_enPassantSquare);
+	undo.halfmoveClock = static_cast<uint16_t>(m_halfmoveClock);
+	undo.hash = m_hash;
+
+	if (undo.capturedPieceId != PieceId::EMPTY)
+	{
+		RemovePiece(capturedSquare, undo.capturedPieceId, opponentId);
+	}
+
+	if (move.IsPromotion())
+	{
+		RemovePiece(from, PieceId::PAWN, colorId);
+		PutPiece(to, move.GetPromotionPieceId(), colorId);
+	}
+	else
+	{
+		ShiftPiece(from, to, pieceId, colorId);
+	}
+
+	if (move.IsCastle())
+	{
+		Square rookFrom;
+		Square rookTo;
+		GetCastlingRookSquares(move, rookFrom, rookTo);
+		ShiftPiece(rookFrom, rookTo, PieceId::ROOK, colorId);
+	}
+
+	if (m_enPassantSquare != s_noSquare)
+	{
+		m_hash ^= s_zobrist.enPassantFile[FileOf(m_enPassantSquare)];
+	}
+
+	// Only record the skipped square when an enemy pawn can actually take on it, so that
+	// positions that only differ by an unusable en-passant square share a hash.
+	m_enPassantSquare = s_noSquare;
+	if (move.GetFlags() == DOUBLE_PAWN_PUSH)
+	{
+		Square skipped = (from + to) / 2;
+		if (GetPawnAttacks(colorId, skipped) & GetPieces(opponentId, PieceId::PAWN))
+		{
+			m_enPassantSquare = skipped;
+			m_hash ^= s_zobrist.enPassantFile[FileOf(m_enPassantSquare)];
+		}
+	}
+
+	m_halfmoveClock = pieceId == PieceId::PAWN || move.IsCapture() ? 0 : m_halfmoveClock + 1;
+	SetCastlingRights(m_castlingRights & s_castlingRightsMask[from] & s_castlingRightsMask[to]);
+	SetSideToMove(opponentId);
+}
+
+void Position::UnmakeMove(Move move, const UndoInfo& undo)
+{
+	Square from = move.GetFrom();
+	Square to = move.GetTo();
+	ColorId colorId = GetOpponent(m_sideToMove);
+
+	if (move.IsCastle())
+	{
+		Square rookFrom;
+		Square rookTo;
+		GetCastlingRookSquares(move, rookFrom, rookTo);
+		ShiftPiece(rookTo, rookFrom, PieceId::ROOK, colorId);
+	}
+
+	if (move.IsPromotion())
+	{
+		RemovePiece(to, move.GetPromotionPieceId(), colorId);
+		PutPiece(from, PieceId::PAWN, colorId);
+	}
+	else
+	{
+		ShiftPiece(to, from, GetPieceIdAt(to), colorId);
+	}
+
+	if (undo.capturedPieceId != PieceId::EMPTY)
+	{
+		PutPiece(move.IsEnPassant() ? to ^ 8 : to, undo.capturedPieceId, GetOpponent(colorId));
+	}
+
+	m_castlingRights = undo.castlingRights;
+	m_enPassantSquare = undo.enPassantSquare;
+	m_halfmoveClock = undo.halfmoveClock;
+	m_sideToMove = colorId;
+
+	// Restoring the key is cheaper than undoing each update to it.
+	m_hash = undo.hash;
+}
+
+Bitboard Position::AttackersTo(Square square, Bitboard occupied) const
+{
+	// A pawn of one color attacks the square if a pawn of the other color on the square would
+	// attack it back; every other piece attacks symmetrically.
+	const auto& white = m_pieces[ColorIndex(ColorId::WHITE)];
+	const auto& black = m_pieces[ColorIndex(ColorId::BLACK)];
+	auto both = [&white, &black](PieceId pieceId)
+	{
+		return white[PieceIndex(pieceId)] | black[PieceIndex(pieceId)];
+	};
+
+	return (GetPawnAttacks(ColorId::BLACK, square) & white[PieceIndex(PieceId::PAWN)])
+		| (GetPawnAttacks(ColorId::WHITE, square) & black[PieceIndex(PieceId::PAWN)])
+		| (GetKnightAttacks(square) & both(PieceId::KNIGHT))
+		| (GetKingAttacks(square) & both(PieceId::KING))
+		| (GetBishopAttacks(square, occupied) & (both(PieceId::BISHOP) | both(PieceId::QUEEN)))
+		| (GetRookAttacks(square, occupied) & (both(PieceId::ROOK) | both(PieceId::QUEEN)));
+}
+
+uint64_t Position::ComputeHash() const
+{
+	uint64_t hash = 0;
+	for (ColorId colorId : { ColorId::WHITE, ColorId::BLACK })
+	{
+		for (int32_t i = 0; i < s_numPieceTypes; ++i)
+		{
+			Bitboard pieces = m_pieces[ColorIndex(colorId)][i];
+			while (pieces)
+			{
+				hash ^= GetPieceKey(colorId, PieceFromIndex(i), PopLsb(pieces));
+			}
+		}
+	}
+
+	hash ^= s_zobrist.castling[m_castlingRights];
+	if (m_enPassantSquare != s_noSquare)
+	{
+		hash ^= s_zobrist.enPassantFile[FileOf(m_enPassantSquare)];
+	}
+	if (m_sideToMove == ColorId::BLACK)
+	{
+		hash ^= s_zobrist.blackToMove;
+	}
+	return hash;
+}
+
+void Position::PutPiece(Square square, PieceId pieceId, ColorId colorId)
+{
+	Bitboard bit = SquareBit(square);
+	m_pieces[ColorIndex(colorId)][PieceIndex(pieceId)] |= bit;
+	m_colors[ColorIndex(colorId)] |= bit;
+	m_occupied |= bit;
+	m_mailbox[square] = MakePiece(colorId, pieceId);
+	m_hash ^= GetPieceKey(colorId, pieceId, square);
+	if (pieceId == PieceId::KING)
+	{
+		m_kingSquares[ColorIndex(colorId)] = square;
+	}
+}
+
+void Position::RemovePiece(Square square, PieceId pieceId, ColorId colorId)
+{
+	Bitboard bit = SquareBit(square);
+	m_pieces[ColorIndex(colorId)][PieceIndex(pieceId)] &= ~bit;
+	m_colors[ColorIndex(colorId)] &= ~bit;
+	m_occupied &= ~bit;
+	m_mailbox[square] = s_noPiece;
+	m_hash ^= GetPieceKey(colorId, pieceId, square);
+	if (pieceId == PieceId::KING)
+	{
+		m_kingSquares[ColorIndex(colorId)] = s_noSquare;
+	}
+}
+
+void Position::ShiftPiece(Square from, Square to, PieceId pieceId, ColorId colorId)
+{
+	Bitboard fromTo = SquareBit(from) | SquareBit(to);
+	m_pieces[ColorIndex(colorId)][PieceIndex(pieceId)] ^= fromTo;
+	m_colors[ColorIndex(colorId)] ^= fromTo;
+	m_occupied ^= fromTo;
+	m_mailbox[to] = m_mailbox[from];
+	m_mailbox[from] = s_noPiece;
+	m_hash ^= GetPieceKey(colorId, pieceId, from) ^ GetPieceKey(colorId, pieceId, to);
+	if (pieceId == PieceId::KING)
+	{
+		m_kingSquares[ColorIndex(colorId)] = to;
+	}
+}
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,155 @@
+//---------------------------------------------------------------
+//
+// Position.h
+//
+
+#pragma once
+
+#include "Bitboard.h"
+#include "Move.h"
+#include "Zobrist.h"
+
+#include <array>
+#include <string>
+
+namespace Chess {
+
+//===============================================================================
+
+// Castling rights, stored as a bitmask in the position.
+enum CastlingRight : uint8_t {
+	NO_CASTLING = 0,
+	WHITE_KINGSIDE = 1 << 0,
+	WHITE_QUEENSIDE = 1 << 1,
+	BLACK_KINGSIDE = 1 << 2,
+	BLACK_QUEENSIDE = 1 << 3,
+	ALL_CASTLING = WHITE_KINGSIDE | WHITE_QUEENSIDE | BLACK_KINGSIDE | BLACK_QUEENSIDE
+};
+
+// Forsyth-Edwards Notation of the standard starting position.
+constexpr const char* s_startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Everything MakeMove destroys that UnmakeMove cannot work out from the move itself.
+struct UndoInfo {
+	PieceId capturedPieceId = PieceId::EMPTY;
+	uint8_t castlingRights = NO_CASTLING;
+	uint8_t enPassantSquare = s_noSquare;
+	uint16_t halfmoveClock = 0;
+	uint64_t hash = 0;
+};
+
+// Piece placement stored as one bitboard per piece type and color, plus occupancy sets and a
+// 64-byte mailbox.
+// Trivially copyable, so copying a position never allocates.
+class Position {
+public:
+	// Removes every piece from the board and resets the game state.
+	void Clear();
+
+	// Sets up the position described by a FEN string. The move counters may be left out.
+	// Returns false and leaves the position cleared if the string is malformed, if either side
+	// does not have exactly one king, if a pawn stands on the first or last rank, if the side
+	// not to move is in check, if the en-passant square does not follow a double push, or if
+	// the halfmove clock is out of range.
+	bool SetFromFen(const std::string& fen);
+
+	// Plays a move in place and hands the side to move over. Fills undo with what is needed to
+	// take the move back. The move's flags must be right for this position.
+	void MakeMove(Move move, UndoInfo& undo);
+
+	// Takes back a move made with MakeMove. Moves must be taken back in reverse order.
+	void UnmakeMove(Move move, const UndoInfo& undo);
+
+	// Places a piece on an empty square.
+	void PutPiece(Square square, PieceId pieceId, ColorId colorId);
+
+	// Returns the piece on the square, or s_noPiece.
+	Piece GetPieceAt(Square square) const { return m_mailbox[square]; }
+
+	// Returns the kind of piece on the square, or EMPTY.
+	PieceId GetPieceIdAt(Square square) const { return GetPieceId(m_mailbox[square]); }
+
+	// Returns the color of the piece on the square, or NONE.
+	ColorId GetColorAt(Square square) const { return GetPieceColor(m_mailbox[square]); }
+
+	Bitboard GetPieces(ColorId colorId, PieceId pieceId) const
+	{
+		return m_pieces[ColorIndex(colorId)][PieceIndex(pieceId)];
+	}
+
+	Bitboard GetPieces(ColorId colorId) const { return m_colors[ColorIndex(colorId)]; }
+	Bitboard GetOccupied() const { return m_occupied; }
+
+	// Returns the square of the king of the given color, or s_noSquare if it has none.
+	Square GetKingSquare(ColorId colorId) const { return m_kingSquares[ColorIndex(colorId)]; }
+
+	// Returns the pieces of both colors that attack the square, with sliders blocked by the
+	// given occupancy rather than the board's. Found by looking outward from the square.
+	Bitboard AttackersTo(Square square, Bitboard occupied) const;
+
+	// Returns whether any piece of the given color attacks the square.
+	bool IsSquareAttacked(Square square, ColorId byColorId) const
+	{
+		return (AttackersTo(square, m_occupied) & GetPieces(byColorId)) != 0;
+	}
+
+	ColorId GetSideToMove() const { return m_sideToMove; }
+	void SetSideToMove(ColorId colorId)
+	{
+		if (colorId != m_sideToMove)
+		{
+			m_hash ^= s_zobrist.blackToMove;
+		}
+		m_sideToMove = colorId;
+	}
+
+	uint8_t GetCastlingRights() const { return m_castlingRights; }
+	void SetCastlingRights(uint8_t castlingRights)
+	{
+		m_hash ^= s_zobrist.castling[m_castlingRights] ^ s_zobrist.castling[castlingRights];
+		m_castlingRights = castlingRights;
+	}
+
+	// Square a pawn skipped over with a double push on the last move, or s_noSquare.
+	Square GetEnPassantSquare() const { return m_enPassantSquare; }
+
+	// Number of moves since the last capture or pawn move.
+	int32_t GetHalfmoveClock() const { return m_halfmoveClock; }
+
+	// Returns the Zobrist key of the position. Kept up to date by every change to the position.
+	uint64_t GetHash() const { return m_hash; }
+
+	// Returns the Zobrist key of the position, computed from scratch. Always equal to GetHash;
+	// useful for checking the incremental updates.
+	uint64_t ComputeHash() const;
+
+private:
+	void RemovePiece(Square square, PieceId pieceId, ColorId colorId);
+	void ShiftPiece(Square from, Square to, PieceId pieceId, ColorId colorId);
+
+private:
+	std::array<std::array<Bitboard, s_numPieceTypes>, s_numColors> m_pieces{};
+	std::array<Bitboard, s_numColors> m_colors{};
+	Bitboard m_occupied = 0;
+
+	// The same placement by square, so asking what is on a square is a single load.
+	std::array<Piece, s_numSquares> m_mailbox = []
+	{
+		std::array<Piece, s_numSquares> mailbox{};
+		mailbox.fill(s_noPiece);
+		return mailbox;
+	}();
+
+	// Kept alongside the king bitboards so finding a king is a load rather than a bit scan.
+	std::array<Square, s_numColors> m_kingSquares{{ s_noSquare, s_noSquare }};
+
+	ColorId m_sideToMove = ColorId::WHITE;
+	uint8_t m_castlingRights = NO_CASTLING;
+	Square m_enPassantSquare = s_noSquare;
+	int32_t m_halfmoveClock = 0;
+	uint64_t m_hash = 0;
+};
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,1022 @@
+//---------------------------------------------------------------
+//
+// Search.cpp
+//
+
+#include "Search.h"
+#include "Evaluate.h"
+#include "MovePicker.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace Chess {
+
+//===============================================================================
+
+// Nodes between looks at the clock and the node counts. Reading them is slow next to searching
+// a node.
+static const uint64_t s_clockCheckInterval = 1024;
+
+// Mate scores count plies from the root, but a stored position may be reached at another ply,
+// so the table holds them counted from the position itself.
+static int32_t ScoreToTable(int32_t score, int32_t ply)
+{
+	if (IsMateScore(score))
+	{
+		return score > 0 ? score + ply : score - ply;
+	}
+	return score;
+}
+
+static int32_t ScoreFromTable(int32_t score, int32_t ply)
+{
+	if (IsMateScore(score))
+	{
+		return score > 0 ? score - ply : score + ply;
+	}
+	return score;
+}
+
+// What a capture may win beyond its material in positional terms. A capture that falls short
+// of alpha by more than this is not searched in the quiescence search.
+static const int32_t s_deltaMargin = 200;
+
+// Nodes at least this deep are split between the threads in YBWC mode. Shallower ones are over
+// too quickly to be worth sharing.
+static const int32_t s_minSplitDepth = 4;
+
+// A node whose remaining moves are being searched by several threads at once. Owned by the
+// thread that split it, which stays until every move is done; the tasks that let other threads
+// join hold it too, since they may only run after that.
+struct SplitPoint {
+	// The node as it stood when it was split, for the joining threads to start from.
+	Position position;
+	std::vector<uint64_t> hashes;
+	MoveList moves;
+	int32_t depth = 0;
+	int32_t beta = 0;
+	int32_t ply = 0;
+
+	// The move that led to the node, for the countermoves of the joining threads.
+	Move previousMove = Move::None();
+
+	// The split point the owner was working for when it split this one, if any. A cutoff
+	// there makes this one pointless too.
+	const SplitPoint* parent = nullptr;
+
+	std::atomic<int32_t> alpha{ 0 };
+	std::atomic<bool> isCutOff{ false };
+
+	// The rest is guarded by the mutex.
+	std::mutex mutex;
+	int32_t nextMoveIndex = 0;
+	int32_t numActiveThreads = 0;
+	int32_t bestScore = 0;
+	Move bestMove = Move::None();
+	std::array<Move, s_maxPly> pv;
+	int32_t pvLength = 0;
+};
+
+// One thread's share of a search: its own copy of the position and everything it learns that
+// is not worth sharing. Worker 0 is the main worker, which keeps the clock and reports.
+class SearchWorker {
+public:
+	SearchWorker(Search& search, int32_t index)
+		: m_search(search)
+		, m_index(index)
+	{
+		for (auto& countermoves : m_countermoves)
+		{
+			countermoves.fill(Move::None());
+		}
+	}
+
+	// Deepens the search of the position until the search stops or the depth limit is reached,
+	// and returns the last completed iteration.
+	SearchInfo Run(const Position& rootPosition, const std::vector<uint64_t>& history,
+		const SearchReporter& reporter);
+
+	// Resets the counters and forgets the killers, and ages the history so that what was learned
+	// in earlier searches counts for less. Must not be called during a search.
+	void NewSearch();
+
+	uint64_t GetNodes() const { return m_nodes.load(std::memory_order_relaxed); }
+	uint64_t GetNumCutoffs() const { return m_numCutoffs.load(std::memory_order_relaxed); }
+	uint64_t GetNumFirstMoveCutoffs() const { return m_numFirstMoveCutoffs.load(std::memory_order_relaxed); }
+
+	// Helps search the remaining moves of a split point, if any are left.
+	void JoinSplit(SplitPoint& splitPoint);
+
+private:
+	bool IsMainWorker() const { return m_index == 0; }
+
+	// Returns whether a helper leaves this iteration to the others, so that the helpers
+	// spread over several depths instead of all searching the same one.
+	bool SkipsDepth(int32_t depth) const;
+
+	// Returns the score of the position searched depth plies deep, within [alpha, beta], and
+	// fills the principal variation at ply.
+	int32_t Negamax(Position& position, int32_t depth, int32_t alpha, int32_t beta, int32_t ply);
+
+	// Returns the score of the position once it is quiet: the static evaluation, unless a
+	// capture or promotion improves on it, or the best evasion when in check.
+	int32_t Quiescence(Position& position, int32_t alpha, int32_t beta, int32_t ply);
+
+	// Returns whether the position is drawn by the fifty move rule or by repetition.
+	bool IsDraw(const Position& position) const;
+
+	// Makes the move the principal variation at ply, followed by the one found below it.
+	void UpdatePv(int32_t ply, Move move);
+
+	// Returns the quiet move that last refuted the previous move, or Move::None().
+	Move GetCountermove(const Position& position, Move previousMove) const;
+
+	// Learns from a quiet move causing a cutoff at ply: it becomes a killer and the countermove
+	// to the previous move, and gains history, while the quiet moves tried before it lose some.
+	void UpdateQuietStats(const Position& position, int32_t ply, int32_t depth, Move move,
+		const MoveList& quietsTried);
+
+	// Returns the index of a piece in the countermove table.
+	static int32_t GetCountermoveIndex(Piece piece)
+	{
+		return ColorIndex(GetPieceColor(piece)) * s_numPieceTypes + PieceIndex(GetPieceId(piece));
+	}
+
+	// Returns whether the result being worked on is no longer wanted: the search stopped, or a
+	// split point this worker is searching for was cut off.
+	bool IsAborted() const;
+
+	// Returns whether a node should hand out its remaining moves.
+	bool ShouldSplit(int32_t depth) const;
+
+	// Searches the given moves of the node at ply together with any idle threads, updating
+	// alpha, the best score and move, and the principal variation at ply.
+	void SearchSplit(const Position& position, const MoveList& moves, int32_t depth, int32_t& alpha,
+		int32_t beta, int32_t ply, int32_t& bestScore, Move& bestMove);
+
+	// Searches moves of the split point until none are left or it is cut off.
+	void SearchSplitMoves(SplitPoint& splitPoint);
+
+private:
+	Search& m_search;
+	TranspositionTable& m_table = m_search.m_table;
+	const int32_t m_index;
+
+	// Only written by this worker; atomic so that the main worker can add them up.
+	std::atomic<uint64_t> m_nodes{ 0 };
+	std::atomic<uint64_t> m_numCutoffs{ 0 };
+	std::atomic<uint64_t> m_numFirstMoveCutoffs{ 0 };
+
+	// Hashes of the game so far and of the positions on the current search path.
+	std::vector<uint64_t> m_hashes;
+
+	// Triangular principal variation table: row ply holds the best line from ply onward.
+	std::array<std::array<Move, s_maxPly>, s_maxPly> m_pvTable;
+	std::array<int32_t, s_maxPly> m_pvLengths{};
+
+	// Principal variation of the previous iteration, and how many of its moves the current
+	// search path still follows.
+	std::vector<Move> m_previousPv;
+	int32_t m_pvFollowPly = 0;
+
+	// Innermost split point this worker is searching moves of, or null.
+	const SplitPoint* m_splitPoint = nullptr;
+
+	// Move ordering learned as the search goes, kept in fixed arrays so that a worker never
+	// allocates for it. Killers are the last two quiet moves to cause a cutoff at each ply;
+	// countermoves are indexed by the piece that made the previous move and its to square.
+	std::array<std::array<Move, 2>, s_maxPly> m_killers;
+	HistoryTable m_history{};
+	std::array<std::array<Move, s_numSquares>, s_numColors * s_numPieceTypes> m_countermoves;
+
+	// The move played at each ply of the current search path.
+	std::array<Move, s_maxPly> m_pathMoves;
+};
+
+// Middlegame and endgame positions for benchmarking the search, from quiet to sharp.
+static const std::array<const char*, 8> s_benchFens{{
+	s_startFen,
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+	"2rq1rk1/pp1bppbp/3p1np1/4n3/3NP3/1BN1BP2/PPPQ2PP/2KR3R w - - 0 12",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	"8/k7/3p4/p2P1p2/P2P1P2/8/8/K7 w - - 0 1",
+}};
+
+// Depth skipping pattern of the helpers: helper i skips the iterations where
+// (depth + phase) / size is odd, with size and phase taken from entry (i - 1) % 20.
+static const std::array<int32_t, 20> s_skipSizes = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const std::array<int32_t, 20> s_skipPhases = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+SearchInfo SearchWorker::Run(const Position& rootPosition, const std::vector<uint64_t>& history,
+	const SearchReporter& reporter)
+{
+	m_hashes = history;
+	m_previousPv.clear();
+
+	Position position = rootPosition;
+	SearchInfo info;
+	uint64_t previousIterationNodes = 0;
+	const int32_t maxDepth = std::min(m_search.m_limits.maxDepth, s_maxSearchDepth);
+	for (int32_t depth = 1; depth <= maxDepth; ++depth)
+	{
+		if (SkipsDepth(depth))
+		{
+			continue;
+		}
+
+		m_pvFollowPly = 0;
+		int32_t score = Negamax(position, depth, -s_infiniteScore, s_infiniteScore, 0);
+		if (m_search.m_stopped.load(std::memory_order_relaxed))
+		{
+			break;
+		}
+
+		m_previousPv.assign(m_pvTable[0].begin(), m_pvTable[0].begin() + m_pvLengths[0]);
+		if (!IsMainWorker())
+		{
+			continue;
+		}
+
+		auto elapsed = Search::Clock::now() - m_search.m_startTime;
+		auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+		uint64_t iterationNodes = m_search.GetTotalNodes() - info.nodes;
+
+		// Lazy SMP helpers search trees of their own at other depths and fill the shared table
+		// ahead of this worker, so no node count then measures how one tree grows.
+		const bool hasLazyHelpers = m_search.m_parallelSearch == ParallelSearchId::LAZY_SMP
+			&& m_search.GetNumThreads() > 1;
+		info.branchingFactor = previousIterationNodes > 0 && !hasLazyHelpers
+			? static_cast<double>(iterationNodes) / static_cast<double>(previousIterationNodes) : 0.0;
+		previousIterationNodes = iterationNodes;
+		info.firstMoveCutoffRate = m_search.GetFirstMoveCutoffRate();
+		info.depth = depth;
+		info.score = score;
+		info.nodes += iterationNodes;
+		info.nodesPerSecond = info.nodes * 1000000 / static_cast<uint64_t>(micros > 0 ? micros : 1);
+		info.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+		info.hashfull = m_table.GetHashfull();
+		info.pv = m_previousPv;
+		if (reporter)
+		{
+			reporter(info);
+		}
+
+		// There is a move to play now, so a limit may cut the next iteration short.
+		m_search.m_canStop = true;
+
+		// Nothing to search, or a mate already seen within the full-width horizon, which a
+		// deeper search cannot improve on.
+		if (info.pv.empty() || (IsMateScore(score) && s_mateScore - std::abs(score) <= depth))
+		{
+			break;
+		}
+	}
+
+	return info;
+}
+
+bool SearchWorker::SkipsDepth(int32_t depth) const
+{
+	if (IsMainWorker())
+	{
+		return false;
+	}
+
+	std::size_t entry = static_cast<std::size_t>(m_index - 1) % s_skipSizes.size();
+	return ((depth + s_skipPhases[entry]) / s_skipSizes[entry]) % 2 != 0;
+}
+
+int32_t SearchWorker::Negamax(Position& position, int32_t depth, int32_t alpha, int32_t beta, int32_t ply)
+{
+	m_pvLengths[ply] = 0;
+	uint64_t nodes = m_nodes.load(std::memory_order_relaxed) + 1;
+	m_nodes.store(nodes, std::memory_order_relaxed);
+
+	if (m_search.ShouldStop(IsMainWorker(), nodes) || (m_splitPoint && IsAborted()))
+	{
+		return 0;
+	}
+	if (ply > 0 && IsDraw(position))
+	{
+		return s_drawScore;
+	}
+	if (ply >= s_maxPly - 1)
+	{
+		return Evaluate(position);
+	}
+	if (depth <= 0)
+	{
+		// Counted again by the quiescence search.
+		m_nodes.store(nodes - 1, std::memory_order_relaxed);
+		return Quiescence(position, alpha, beta, ply);
+	}
+
+	const uint64_t hash = position.GetHash();
+	TableHit hit;
+	Move hashMove = Move::None();
+	if (m_table.Probe(hash, hit))
+	{
+		hashMove = hit.move;
+
+		// A deep enough result settles the node if it falls outside the window. One inside it
+		// is searched again anyway, so that the principal variation comes out whole.
+		int32_t score = ScoreFromTable(hit.score, ply);
+		if (ply > 0 && hit.depth >= depth
+			&& ((hit.bound != BoundId::UPPER && score >= beta) || (hit.bound != BoundId::LOWER && score <= alpha)))
+		{
+			return score;
+		}
+	}
+
+	const CheckInfo checkInfo = ComputeCheckInfo(position);
+
+	// The previous iteration's best line is the best guess for as long as the path follows it.
+	Move pvMove = Move::None();
+	if (m_pvFollowPly == ply && ply < static_cast<int32_t>(m_previousPv.size()))
+	{
+		pvMove = m_previousPv[ply];
+		hashMove = pvMove;
+	}
+
+	const std::array<Move, 2>& killers = m_killers[ply];
+	Move countermove = ply > 0 ? GetCountermove(position, m_pathMoves[ply - 1]) : Move::None();
+	MovePicker picker(position, checkInfo, hashMove, killers[0], killers[1], countermove, &m_history);
+	m_hashes.push_back(hash);
+
+	const int32_t originalAlpha = alpha;
+	int32_t bestScore = -s_infiniteScore;
+	Move bestMove = Move::None();
+	int32_t numMoves = 0;
+	MoveList quietsTried;
+	for (Move move = picker.GetNextMove(); move != Move::None(); move = picker.GetNextMove())
+	{
+		++numMoves;
+
+		// Once the eldest brother is searched without a cutoff, the rest can go in parallel.
+		if (numMoves > 1 && ShouldSplit(depth))
+		{
+			MoveList moves;
+			for (; move != Move::None(); move = picker.GetNextMove())
+			{
+				moves.Add(move);
+			}
+			SearchSplit(position, moves, depth, alpha, beta, ply, bestScore, bestMove);
+			break;
+		}
+
+		UndoInfo undo;
+		position.MakeMove(move, undo);
+		m_pathMoves[ply] = move;
+		if (move == pvMove)
+		{
+			m_pvFollowPly = ply + 1;
+		}
+		int32_t score = -Negamax(position, depth - 1, -beta, -alpha, ply + 1);
+		position.UnmakeMove(move, undo);
+		m_pvFollowPly = std::min(m_pvFollowPly, ply);
+
+		if (IsAborted())
+		{
+			m_hashes.pop_back();
+			return 0;
+		}
+
+		if (!move.IsCapture() && !move.IsPromotion())
+		{
+			quietsTried.Add(move);
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			if (score > alpha)
+			{
+				alpha = score;
+				bestMove = move;
+				UpdatePv(ply, move);
+				if (alpha >= beta)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	m_hashes.pop_back();
+
+	if (IsAborted())
+	{
+		return 0;
+	}
+	if (numMoves == 0)
+	{
+		return checkInfo.checkers ? -(s_mateScore - ply) : s_drawScore;
+	}
+
+	if (bestScore >= beta)
+	{
+		m_numCutoffs.store(m_numCutoffs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		if (numMoves == 1)
+		{
+			m_numFirstMoveCutoffs.store(m_numFirstMoveCutoffs.load(std::memory_order_relaxed) + 1,
+				std::memory_order_relaxed);
+		}
+		if (!bestMove.IsCapture() && !bestMove.IsPromotion())
+		{
+			UpdateQuietStats(position, ply, depth, bestMove, quietsTried);
+		}
+	}
+
+	BoundId bound = bestScore >= beta ? BoundId::LOWER
+		: bestScore > originalAlpha ? BoundId::EXACT : BoundId::UPPER;
+	m_table.Store(hash, bestMove, ScoreToTable(bestScore, ply), depth, bound);
+	return bestScore;
+}
+
+// Returns the material a capture or promotion wins, in centipawns, if it is not recaptured.
+static int32_t GetMaterialGain(const Position& position, Move move)
+{
+	int32_t gain = 0;
+	if (move.IsCapture())
+	{
+		PieceId victimId = move.IsEnPassant() ? PieceId::PAWN : position.GetPieceIdAt(move.GetTo());
+		gain += GetPieceTypeInfo(victimId).points * s_pawnValue;
+	}
+	if (move.IsPromotion())
+	{
+		gain += (GetPieceTypeInfo(move.GetPromotionPieceId()).points - GetPieceTypeInfo(PieceId::PAWN).points) * s_pawnValue;
+	}
+	return gain;
+}
+
+int32_t SearchWorker::Quiescence(Position& position, int32_t alpha, int32_t beta, int32_t ply)
+{
+	m_pvLengths[ply] = 0;
+	uint64_t nodes = m_nodes.load(std::memory_order_relaxed) + 1;
+	m_nodes.store(nodes, std::memory_order_relaxed);
+
+	if (m_search.ShouldStop(IsMainWorker(), nodes) || (m_splitPoint && IsAborted()))
+	{
+		return 0;
+	}
+	if (IsDraw(position))
+	{
+		return s_drawScore;
+	}
+	if (ply >= s_maxPly - 1)
+	{
+		return Evaluate(position);
+	}
+
+	const CheckInfo checkInfo = ComputeCheckInfo(position);
+	const bool isInCheck = checkInfo.checkers != 0;
+
+	// Out of check the side to move may stand pat rather than capture, so the evaluation is a
+	// lower bound. In check every evasion has to be tried, and having none is mate.
+	int32_t standPat = -s_infiniteScore;
+	int32_t bestScore = -s_infiniteScore;
+	if (!isInCheck)
+	{
+		standPat = Evaluate(position);
+		bestScore = standPat;
+		if (bestScore >= beta)
+		{
+			return bestScore;
+		}
+		alpha = std::max(alpha, bestScore);
+	}
+
+	MovePicker picker(position, checkInfo, &m_history);
+	m_hashes.push_back(position.GetHash());
+
+	int32_t numMoves = 0;
+	for (Move move = picker.GetNextMove(); move != Move::None(); move = picker.GetNextMove())
+	{
+		++numMoves;
+
+		// Delta pruning: skip a capture that cannot reach alpha even if it goes unanswered.
+		if (!isInCheck && standPat + GetMaterialGain(position, move) + s_deltaMargin <= alpha)
+		{
+			continue;
+		}
+
+		UndoInfo undo;
+		position.MakeMove(move, undo);
+		m_pathMoves[ply] = move;
+		int32_t score = -Quiescence(position, -beta, -alpha, ply + 1);
+		position.UnmakeMove(move, undo);
+
+		if (IsAborted())
+		{
+			m_hashes.pop_back();
+			return 0;
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			if (score > alpha)
+			{
+				alpha = score;
+				UpdatePv(ply, move);
+				if (alpha >= beta)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	m_hashes.pop_back();
+
+	if (isInCheck && numMoves == 0)
+	{
+		return -(s_mateScore - ply);
+	}
+	return bestScore;
+}
+
+bool SearchWorker::IsDraw(const Position& position) const
+{
+	if (position.GetHalfmoveClock() >= 100)
+	{
+		return true;
+	}
+
+	// A repetition needs the same side to move, and nothing before the last capture or pawn
+	// move can repeat. Within the search one repetition is enough: whatever held the first
+	// time holds again.
+	const int32_t numHashes = static_cast<int32_t>(m_hashes.size());
+	const int32_t oldest = std::max(0, numHashes - position.GetHalfmoveClock());
+	for (int32_t i = numHashes - 2; i >= oldest; i -= 2)
+	{
+		if (m_hashes[i] == position.GetHash())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void SearchWorker::UpdatePv(int32_t ply, Move move)
+{
+	const int32_t childLength = m_pvLengths[ply + 1];
+	m_pvTable[ply][0] = move;
+	std::copy_n(m_pvTable[ply + 1].begin(), childLength, m_pvTable[ply].begin() + 1);
+	m_pvLengths[ply] = childLength + 1;
+}
+
+void SearchWorker::NewSearch()
+{
+	m_nodes.store(0, std::memory_order_relaxed);
+	m_numCutoffs.store(0, std::memory_order_relaxed);
+	m_numFirstMoveCutoffs.store(0, std::memory_order_relaxed);
+
+	for (auto& killers : m_killers)
+	{
+		killers.fill(Move::None());
+	}
+	for (auto& side : m_history)
+	{
+		for (auto& from : side)
+		{
+			for (int32_t& score : from)
+			{
+				score /= 2;
+			}
+		}
+	}
+}
+
+Move SearchWorker::GetCountermove(const Position& position, Move previousMove) const
+{
+	// The piece may have promoted; what stands there now is what has to be answered.
+	Piece piece = position.GetPieceAt(previousMove.GetTo());
+	if (previousMove == Move::None() || piece == s_noPiece)
+	{
+		return Move::None();
+	}
+	return m_countermoves[GetCountermoveIndex(piece)][previousMove.GetTo()];
+}
+
+// Moves a history score towards plus or minus s_maxHistoryScore by the bonus, less the closer
+// it already is, so that scores never leave the range and recent results count for more.
+static void AddHistoryBonus(int32_t& score, int32_t bonus)
+{
+	score += bonus - score * std::abs(bonus) / s_maxHistoryScore;
+}
+
+void SearchWorker::UpdateQuietStats(const Position& position, int32_t ply, int32_t depth, Move move,
+	const MoveList& quietsTried)
+{
+	std::array<Move, 2>& killers = m_killers[ply];
+	if (killers[0] != move)
+	{
+		killers[1] = killers[0];
+		killers[0] = move;
+	}
+
+	if (ply > 0)
+	{
+		Move previousMove = m_pathMoves[ply - 1];
+		Piece piece = position.GetPieceAt(previousMove.GetTo());
+		if (previousMove != Move::None() && piece != s_noPiece)
+		{
+			m_countermoves[GetCountermoveIndex(piece)][previousMove.GetTo()] = move;
+		}
+	}
+
+	// Deep cutoffs say more than shallow ones.
+	const int32_t bonus = std::min(depth * depth, s_maxHistoryScore / 4);
+	auto& sideHistory = m_history[ColorIndex(position.GetSideToMove())];
+	AddHistoryBonus(sideHistory[move.GetFrom()][move.GetTo()], bonus);
+	for (Move quiet : quietsTried)
+	{
+		if (quiet != move)
+		{
+			AddHistoryBonus(sideHistory[quiet.GetFrom()][quiet.GetTo()], -bonus);
+		}
+	}
+}
+
+bool SearchWorker::IsAborted() const
+{
+	if (m_search.m_stopped.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+	for (const SplitPoint* splitPoint = m_splitPoint; splitPoint; splitPoint = splitPoint->parent)
+	{
+		if (splitPoint->isCutOff.load(std::memory_order_relaxed))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SearchWorker::ShouldSplit(int32_t depth) const
+{
+	return m_search.m_parallelSearch == ParallelSearchId::YBWC && m_search.m_pool
+		&& depth >= s_minSplitDepth && !IsAborted();
+}
+
+void SearchWorker::SearchSplit(const Position& position, const MoveList& moves, int32_t depth,
+	int32_t& alpha, int32_t beta, int32_t ply, int32_t& bestScore, Move& bestMove)
+{
+	auto splitPoint = std::make_shared<SplitPoint>();
+	splitPoint->position = position;
+	splitPoint->hashes = m_hashes;
+	splitPoint->moves = moves;
+	splitPoint->depth = depth;
+	splitPoint->beta = beta;
+	splitPoint->ply = ply;
+	splitPoint->previousMove = ply > 0 ? m_pathMoves[ply - 1] : Move::None();
+	splitPoint->parent = m_splitPoint;
+	splitPoint->alpha = alpha;
+	splitPoint->numActiveThreads = 1;
+	splitPoint->bestScore = bestScore;
+
+	// Every pool thread is offered the split point; those that find no moves left just return.
+	ThreadPool& pool = *m_search.m_pool;
+	for (int32_t i = 0; i < pool.GetNumThreads(); ++i)
+	{
+		Search& search = m_search;
+		pool.Submit([&search, splitPoint]()
+		{
+			search.GetCurrentWorker().JoinSplit(*splitPoint);
+		});
+	}
+
+	const SplitPoint* parent = m_splitPoint;
+	m_splitPoint = splitPoint.get();
+	SearchSplitMoves(*splitPoint);
+	m_splitPoint = parent;
+
+	// Close the split point, so no thread joins late, and wait for the ones still searching.
+	// The main worker keeps an eye on the clock meanwhile, since it is not counting nodes.
+	std::unique_lock<std::mutex> lock(splitPoint->mutex);
+	splitPoint->nextMoveIndex = splitPoint->moves.GetSize();
+	--splitPoint->numActiveThreads;
+	while (splitPoint->numActiveThreads > 0)
+	{
+		lock.unlock();
+		if (IsMainWorker())
+		{
+			m_search.CheckLimits();
+		}
+		std::this_thread::yield();
+		lock.lock();
+	}
+
+	if (splitPoint->bestMove != Move::None())
+	{
+		bestMove = splitPoint->bestMove;
+		std::copy_n(splitPoint->pv.begin(), splitPoint->pvLength, m_pvTable[ply].begin());
+		m_pvLengths[ply] = splitPoint->pvLength;
+	}
+	bestScore = splitPoint->bestScore;
+	alpha = splitPoint->alpha;
+}
+
+void SearchWorker::JoinSplit(SplitPoint& splitPoint)
+{
+	{
+		std::lock_guard<std::mutex> lock(splitPoint.mutex);
+		if (splitPoint.nextMoveIndex >= splitPoint.moves.GetSize())
+		{
+			return;
+		}
+		++splitPoint.numActiveThreads;
+	}
+
+	// The owner is waiting, so the split point and its parents stay alive until this returns.
+	m_hashes = splitPoint.hashes;
+	m_pvFollowPly = -1;
+	if (splitPoint.ply > 0)
+	{
+		m_pathMoves[splitPoint.ply - 1] = splitPoint.previousMove;
+	}
+	m_splitPoint = &splitPoint;
+	SearchSplitMoves(splitPoint);
+	m_splitPoint = nullptr;
+
+	std::lock_guard<std::mutex> lock(splitPoint.mutex);
+	--splitPoint.numActiveThreads;
+}
+
+void SearchWorker::SearchSplitMoves(SplitPoint& splitPoint)
+{
+	const int32_t ply = splitPoint.ply;
+	Position position = splitPoint.position;
+	for (;;)
+	{
+		Move move = Move::None();
+		{
+			std::lock_guard<std::mutex> lock(splitPoint.mutex);
+			if (splitPoint.nextMoveIndex >= splitPoint.moves.GetSize())
+			{
+				return;
+			}
+			move = splitPoint.moves[splitPoint.nextMoveIndex++];
+		}
+
+		UndoInfo undo;
+		position.MakeMove(move, undo);
+		m_pathMoves[ply] = move;
+		int32_t alpha = splitPoint.alpha.load(std::memory_order_relaxed);
+		int32_t score = -Negamax(position, splitPoint.depth - 1, -splitPoint.beta, -alpha, ply + 1);
+		position.UnmakeMove(move, undo);
+
+		if (IsAborted())
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(splitPoint.mutex);
+		if (score <= splitPoint.bestScore)
+		{
+			continue;
+		}
+		splitPoint.bestScore = score;
+		if (score > splitPoint.alpha.load(std::memory_order_relaxed))
+		{
+			splitPoint.alpha = score;
+			splitPoint.bestMove = move;
+			splitPoint.pv[0] = move;
+			std::copy_n(m_pvTable[ply + 1].begin(), m_pvLengths[ply + 1], splitPoint.pv.begin() + 1);
+			splitPoint.pvLength = m_pvLengths[ply + 1] + 1;
+			if (score >= splitPoint.beta)
+			{
+				splitPoint.isCutOff = true;
+				return;
+			}
+		}
+	}
+}
+
+Search::Search(const SearchOptions& options)
+	: m_table(options.hashMegabytes)
+	, m_hashMegabytes(options.hashMegabytes)
+{
+	SetOptions(options);
+}
+
+// Out of line, where SearchWorker is complete.
+Search::~Search() = default;
+
+void Search::SetOptions(const SearchOptions& options)
+{
+	m_parallelSearch = options.parallelSearch;
+	if (options.hashMegabytes != m_hashMegabytes)
+	{
+		m_table.Resize(options.hashMegabytes);
+		m_hashMegabytes = options.hashMegabytes;
+	}
+
+	int32_t numThreads = options.numThreads;
+	if (numThreads <= 0)
+	{
+		numThreads = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+	}
+	if (numThreads == GetNumThreads())
+	{
+		return;
+	}
+
+	m_pool.reset(numThreads > 1 ? new ThreadPool(numThreads - 1) : nullptr);
+	m_workers.clear();
+	for (int32_t i = 0; i < numThreads; ++i)
+	{
+		m_workers.push_back(std::make_unique<SearchWorker>(*this, i));
+	}
+}
+
+SearchInfo Search::Run(const Position& position, const std::vector<uint64_t>& history,
+	const SearchLimits& limits, const SearchReporter& reporter)
+{
+	m_limits = limits;
+	m_startTime = Clock::now();
+	m_stopRequested = false;
+	m_stopped = false;
+	m_canStop = false;
+	m_table.NewSearch();
+	for (auto& worker : m_workers)
+	{
+		worker->NewSearch();
+	}
+
+	// Lazy SMP helpers copy the position and history as they start, before the main worker
+	// returns. YBWC helpers are only called on as the main worker splits.
+	for (std::size_t i = 1; m_parallelSearch == ParallelSearchId::LAZY_SMP && i < m_workers.size(); ++i)
+	{
+		SearchWorker* worker = m_workers[i].get();
+		m_pool->Submit([worker, &position, &history]()
+		{
+			worker->Run(position, history, nullptr);
+		});
+	}
+
+	SearchInfo info = m_workers[0]->Run(position, history, reporter);
+
+	m_stopped = true;
+	if (m_pool)
+	{
+		m_pool->WaitIdle();
+	}
+	info.nodes = GetTotalNodes();
+	return info;
+}
+
+bool Search::ShouldStop(bool isMainWorker, uint64_t mainWorkerNodes)
+{
+	if (m_stopped.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+	if (!isMainWorker || !m_canStop)
+	{
+		return false;
+	}
+
+	if (m_stopRequested.load(std::memory_order_relaxed) || mainWorkerNodes % s_clockCheckInterval == 0)
+	{
+		CheckLimits();
+	}
+	return m_stopped.load(std::memory_order_relaxed);
+}
+
+void Search::CheckLimits()
+{
+	if (!m_canStop)
+	{
+		return;
+	}
+
+	bool isOutOfNodes = m_limits.maxNodes > 0 && GetTotalNodes() >= m_limits.maxNodes;
+	bool isOutOfTime = m_limits.moveTime.count() > 0 && Clock::now() - m_startTime >= m_limits.moveTime;
+	if (m_stopRequested.load(std::memory_order_relaxed) || isOutOfNodes || isOutOfTime)
+	{
+		m_stopped = true;
+	}
+}
+
+SearchWorker& Search::GetCurrentWorker()
+{
+	int32_t index = m_pool ? m_pool->GetCurrentWorkerIndex() : -1;
+	return *m_workers[index + 1];
+}
+
+double Search::GetFirstMoveCutoffRate() const
+{
+	uint64_t numCutoffs = 0;
+	uint64_t numFirstMoveCutoffs = 0;
+	for (const auto& worker : m_workers)
+	{
+		numCutoffs += worker->GetNumCutoffs();
+		numFirstMoveCutoffs += worker->GetNumFirstMoveCutoffs();
+	}
+	return numCutoffs > 0 ? static_cast<double>(numFirstMoveCutoffs) / static_cast<double>(numCutoffs) : 0.0;
+}
+
+uint64_t Search::GetTotalNodes() const
+{
+	uint64_t nodes = 0;
+	for (const auto& worker : m_workers)
+	{
+		nodes += worker->GetNodes();
+	}
+	return nodes;
+}
+
+void RunSearchBench(const SearchOptions& options, int32_t depth, std::ostream& out)
+{
+	Search search(options);
+	SearchLimits limits;
+	limits.maxDepth = depth;
+
+	uint64_t totalNodes = 0;
+	std::chrono::milliseconds totalElapsed{ 0 };
+	double totalBranchingFactor = 0.0;
+	int32_t numBranchingFactors = 0;
+	double totalFirstMoveCutoffRate = 0.0;
+	for (const char* fen : s_benchFens)
+	{
+		Position position;
+		position.SetFromFen(fen);
+		search.ClearHash();
+
+		SearchInfo info = search.Run(position, {}, limits);
+		totalNodes += info.nodes;
+		totalElapsed += info.elapsed;
+		totalBranchingFactor += info.branchingFactor;
+		numBranchingFactors += info.branchingFactor > 0.0;
+		totalFirstMoveCutoffRate += info.firstMoveCutoffRate;
+
+		out << "depth " << info.depth << " time " << info.elapsed.count() << " nodes " << info.nodes
+			<< std::fixed << std::setprecision(2);
+		if (info.branchingFactor > 0.0)
+		{
+			out << " ebf " << info.branchingFactor;
+		}
+		out << std::setprecision(1) << " firstcut " << info.firstMoveCutoffRate * 100 << "%"
+			<< " bestmove " << (info.pv.empty() ? "(none)" : GetMoveString(info.pv.front()))
+			<< " score " << GetScoreString(info.score) << "  " << fen << "\n";
+	}
+
+	auto millis = totalElapsed.count();
+	const double numPositions = static_cast<double>(s_benchFens.size());
+	out << "\nThreads: " << search.GetNumThreads()
+		<< (options.parallelSearch == ParallelSearchId::YBWC ? " (YBWC)" : " (Lazy SMP)") << "\n";
+	out << "Total nodes: " << totalNodes << "\n";
+	out << "Time: " << millis << " ms\n";
+	out << "NPS: " << totalNodes * 1000 / static_cast<uint64_t>(millis > 0 ? millis : 1) << "\n";
+	if (numBranchingFactors > 0)
+	{
+		out << std::fixed << std::setprecision(2) << "Mean branching factor: "
+			<< totalBranchingFactor / numBranchingFactors << "\n";
+	}
+	out << std::setprecision(1) << "Mean first move cutoffs: " << totalFirstMoveCutoffRate / numPositions * 100 << "%\n";
+}
+
+std::string GetScoreString(int32_t score)
+{
+	if (!IsMateScore(score))
+	{
+		return "cp " + std::to_string(score);
+	}
+
+	// Plies to mate, rounded up to whole moves.
+	int32_t moves = score > 0 ? (s_mateScore - score + 1) / 2 : -(s_mateScore + score) / 2;
+	return "mate " + std::to_string(moves);
+}
+
+void PrintSearchInfo(const SearchInfo& info, std::ostream& out)
+{
+	out << "depth " << info.depth
+		<< " score " << GetScoreString(info.score)
+		<< " nodes " << info.nodes
+		<< " nps " << info.nodesPerSecond
+		<< " time " << info.elapsed.count()
+		<< " hashfull " << info.hashfull
+		<< " pv";
+	for (Move move : info.pv)
+	{
+		out << " " << GetMoveString(move);
+	}
+	out << "\n";
+}
+
+//===============================================================================
+
+} // namespace Chess
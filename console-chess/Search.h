@@ -0,0 +1,202 @@
+//---------------------------------------------------------------
+//
+// Search.h
+//
+
+#pragma once
+
+#include "Position.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Chess {
+
+//===============================================================================
+
+// Deepest ply the search can reach, counting from the root.
+constexpr int32_t s_maxPly = 128;
+
+// Deepest iteration the search will start.
+constexpr int32_t s_maxSearchDepth = 64;
+
+// Score of being mated right now. Being mated n plies from the root scores -(s_mateScore - n).
+constexpr int32_t s_mateScore = 32000;
+
+// Bigger than any score, for the bounds of the root window.
+constexpr int32_t s_infiniteScore = s_mateScore + 1;
+
+constexpr int32_t s_drawScore = 0;
+
+// Returns whether a score means a forced mate for one side.
+constexpr bool IsMateScore(int32_t score)
+{
+	return score >= s_mateScore - s_maxPly || score <= -(s_mateScore - s_maxPly);
+}
+
+// Limits on a search. It stops at whichever is reached first; zero means no limit. The first
+// iteration always runs to completion so that there is a move to play.
+struct SearchLimits {
+	int32_t maxDepth = s_maxSearchDepth;
+
+	// Counted over every thread and only checked every so often, so it may be overshot a little.
+	uint64_t maxNodes = 0;
+
+	std::chrono::milliseconds moveTime{ 0 };
+};
+
+// How a search with more than one thread divides the work.
+enum struct ParallelSearchId : uint32_t {
+	// Every thread searches the whole tree, sharing what it learns through the transposition table.
+	LAZY_SMP = 0,
+
+	// Young brothers wait: once the first move of a node has been searched without a cutoff,
+	// the remaining moves are shared out between the threads through the pool.
+	YBWC
+};
+
+// How a search is set up. Unlike the limits, these stay the same from one search to the next.
+struct SearchOptions {
+	// Size of the transposition table in megabytes.
+	std::size_t hashMegabytes = TranspositionTable::s_defaultMegabytes;
+
+	// Number of threads to search with. 1 searches on the calling thread, 0 uses every hardware thread.
+	int32_t numThreads = 1;
+
+	// How more than one thread divides the work.
+	ParallelSearchId parallelSearch = ParallelSearchId::LAZY_SMP;
+};
+
+// Outcome of one completed iteration.
+struct SearchInfo {
+	int32_t depth = 0;
+
+	// In centipawns from the side to move's point of view, or a mate score.
+	int32_t score = 0;
+
+	// Nodes searched by every thread since the search started, not just in this iteration.
+	uint64_t nodes = 0;
+	uint64_t nodesPerSecond = 0;
+	std::chrono::milliseconds elapsed{ 0 };
+
+	// Permille of the transposition table filled by this search.
+	int32_t hashfull = 0;
+
+	// Nodes of this iteration over nodes of the previous one: the effective branching factor.
+	// 0 for the first iteration, and under Lazy SMP with helper threads, whose own searches
+	// make the node counts meaningless for it.
+	double branchingFactor = 0.0;
+
+	// Share of the cutoffs so far that came from the first move tried, a measure of how well
+	// moves are ordered.
+	double firstMoveCutoffRate = 0.0;
+
+	// Principal variation: the best line found, best move first. Empty if there is no legal move.
+	std::vector<Move> pv;
+};
+
+// Called after each completed iteration.
+using SearchReporter = std::function<void(const SearchInfo&)>;
+
+class SearchWorker;
+
+// Negamax alpha-beta search with iterative deepening. Each iteration searches the previous
+// principal variation first, then the best move stored in the transposition table. The table
+// is kept between searches.
+//
+// With more than one thread the search is either Lazy SMP, where helper threads search the same
+// root at staggered depths and share only the transposition table, or YBWC, where the calling
+// thread deepens alone and hands out the later moves of deep nodes to the pool as it goes.
+// Either way the calling thread keeps the clock and plays its own result.
+// Not thread safe, apart from Stop.
+class Search {
+public:
+	explicit Search(const SearchOptions& options = {});
+	~Search();
+
+	Search(const Search&) = delete;
+	Search& operator=(const Search&) = delete;
+
+	// Applies new options. Reallocating the transposition table drops everything in it. Must not
+	// be called during a search.
+	void SetOptions(const SearchOptions& options);
+
+	// Forgets everything learned by earlier searches, e.g. before starting an unrelated game.
+	void ClearHash() { m_table.Clear(); }
+
+	// Searches the position until a limit is reached or Stop is called, and returns the last
+	// iteration completed by the calling thread. history holds the hashes of the positions
+	// played before this one, oldest first, so that repeating one of them scores as a draw.
+	SearchInfo Run(const Position& position, const std::vector<uint64_t>& history,
+		const SearchLimits& limits, const SearchReporter& reporter = nullptr);
+
+	// Makes a running search return as soon as possible. May be called from any thread.
+	void Stop() { m_stopRequested = true; }
+
+	int32_t GetNumThreads() const { return static_cast<int32_t>(m_workers.size()); }
+
+private:
+	friend class SearchWorker;
+
+	using Clock = std::chrono::steady_clock;
+
+	// Returns whether the search has to stop. Only the main worker decides, checking the limits
+	// every so often; helpers just follow.
+	bool ShouldStop(bool isMainWorker, uint64_t mainWorkerNodes);
+
+	// Stops the search if Stop was called or a limit is reached. Only for the main worker.
+	void CheckLimits();
+
+	// Returns the worker for the calling thread: the main worker for the thread that called
+	// Run, otherwise the one belonging to the pool thread.
+	SearchWorker& GetCurrentWorker();
+
+	// Returns the nodes searched by every worker so far.
+	uint64_t GetTotalNodes() const;
+
+	// Returns the share of the cutoffs by every worker so far made by the first move tried.
+	double GetFirstMoveCutoffRate() const;
+
+private:
+	TranspositionTable m_table;
+
+	// Size asked for, which the table rounds down, so that the same options never reallocate it.
+	std::size_t m_hashMegabytes = 0;
+
+	// The first worker searches on the calling thread, the rest on the pool.
+	std::vector<std::unique_ptr<SearchWorker>> m_workers;
+	std::unique_ptr<ThreadPool> m_pool;
+	ParallelSearchId m_parallelSearch = ParallelSearchId::LAZY_SMP;
+
+	// Set by Run before any worker starts, then only read.
+	SearchLimits m_limits;
+	Clock::time_point m_startTime;
+	std::atomic<bool> m_stopRequested{ false };
+	std::atomic<bool> m_stopped{ false };
+
+	// Set once the main worker has a move to play, so that a limit may cut the search short.
+	// Only used by the main worker.
+	bool m_canStop = false;
+};
+
+// Returns a score as "cp <centipawns>" or "mate <moves>", negative when the side to move is
+// getting mated.
+std::string GetScoreString(int32_t score);
+
+// Searches a fixed set of positions to the given depth, each with an empty transposition
+// table, and prints the time to depth, nodes and best move of each, then the totals.
+void RunSearchBench(const SearchOptions& options, int32_t depth, std::ostream& out);
+
+// Prints an iteration on one line: depth, score, nodes, nodes per second, time, hashfull and PV.
+void PrintSearchInfo(const SearchInfo& info, std::ostream& out);
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,139 @@
+//---------------------------------------------------------------
+//
+// ThreadPool.cpp
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace Chess {
+
+//===============================================================================
+
+// The pool and queue the calling thread works for, if it is a worker.
+static thread_local const ThreadPool* s_workerPool = nullptr;
+static thread_local int32_t s_workerIndex = -1;
+
+ThreadPool::ThreadPool(int32_t numThreads)
+{
+	if (numThreads <= 0)
+	{
+		numThreads = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+	}
+
+	for (int32_t i = 0; i < numThreads; ++i)
+	{
+		m_queues.push_back(std::make_unique<WorkQueue>());
+	}
+	for (int32_t i = 0; i < numThreads; ++i)
+	{
+		m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::Submit(Task task)
+{
+	// Workers keep the tasks they spawn, which keeps related work on one thread until stolen.
+	int32_t index = s_workerPool == this
+		? s_workerIndex
+		: static_cast<int32_t>(m_nextQueue++ % m_queues.size());
+
+	m_pendingTasks++;
+	{
+		WorkQueue& queue = *m_queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queuedTasks++;
+	}
+	m_wakeCondition.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idleCondition.wait(lock, [this] { return m_pendingTasks == 0; });
+}
+
+int32_t ThreadPool::GetCurrentWorkerIndex() const
+{
+	return s_workerPool == this ? s_workerIndex : -1;
+}
+
+void ThreadPool::WorkerLoop(int32_t index)
+{
+	s_workerPool = this;
+	s_workerIndex = index;
+
+	for (;;)
+	{
+		Task task;
+		if (TryPopTask(index, task))
+		{
+			task();
+			if (--m_pendingTasks == 0)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_idleCondition.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wakeCondition.wait(lock, [this] { return m_stopping || m_queuedTasks > 0; });
+		if (m_stopping && m_queuedTasks <= 0)
+		{
+			return;
+		}
+	}
+}
+
+bool ThreadPool::TryPopTask(int32_t index, Task& task)
+{
+	int32_t numQueues = static_cast<int32_t>(m_queues.size());
+	for (int32_t i = 0; i < numQueues; ++i)
+	{
+		WorkQueue& queue = *m_queues[(index + i) % numQueues];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+		{
+			continue;
+		}
+
+		// Own queue from the back, so a worker finishes what it just split off first.
+		if (i == 0)
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		m_queuedTasks--;
+		return true;
+	}
+	return false;
+}
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,80 @@
+//---------------------------------------------------------------
+//
+// ThreadPool.h
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Chess {
+
+//===============================================================================
+
+// Fixed set of worker threads, each with its own task queue. A worker runs its newest task
+// first and, when its queue is empty, steals the oldest task of another worker. Tasks may
+// submit more tasks; those go to the submitting worker's own queue.
+class ThreadPool {
+public:
+	using Task = std::function<void()>;
+
+	// Starts the given number of workers, or one per hardware thread if numThreads is 0.
+	explicit ThreadPool(int32_t numThreads = 0);
+
+	// Runs every queued task, then joins the workers.
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Queues a task to run on some worker.
+	void Submit(Task task);
+
+	// Blocks until every submitted task, including those submitted by tasks, has finished.
+	// Must not be called from a worker.
+	void WaitIdle();
+
+	int32_t GetNumThreads() const { return static_cast<int32_t>(m_threads.size()); }
+
+	// Returns the index [0, GetNumThreads()) of the worker of this pool running the calling
+	// thread, or -1 if the calling thread is not one of them.
+	int32_t GetCurrentWorkerIndex() const;
+
+private:
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void WorkerLoop(int32_t index);
+
+	// Takes the newest task of the worker's own queue, or else steals the oldest of another's.
+	bool TryPopTask(int32_t index, Task& task);
+
+private:
+	std::vector<std::unique_ptr<WorkQueue>> m_queues;
+	std::vector<std::thread> m_threads;
+
+	// Guards sleeping and waking; the counts themselves are atomic.
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition;
+	std::condition_variable m_idleCondition;
+
+	// Tasks sitting in a queue, and tasks submitted but not yet finished.
+	std::atomic<int64_t> m_queuedTasks{ 0 };
+	std::atomic<int64_t> m_pendingTasks{ 0 };
+	std::atomic<uint32_t> m_nextQueue{ 0 };
+	bool m_stopping = false;
+};
+
+//===============================================================================
+
+} // namespace Chess
@@ -0,0 +1,141 @@
+//---------------------------------------------------------------
+//
+// TranspositionTable.cpp
+//
+
+#include "TranspositionTable.h"
+
+#include <algorithm>
+
+namespace Chess {
+
+//===============================================================================
+
+// How much deeper a result must be, per search of age, to keep its entry over a new one.
+static const int32_t s_agePenalty = 8;
+
+// A new result for a position already stored replaces it unless it is this much shallower.
+static const int32_t s_sameKeyDepthMargin = 4;
+
+TranspositionTable::TranspositionTable(std::size_t megabytes)
+{
+	Resize(megabytes);
+}
+
+void TranspositionTable::Resize(std::size_t megabytes)
+{
+	std::size_t numBuckets = GetHashTableSize(megabytes, sizeof(Bucket));
+	if (numBuckets != m_numBuckets)
+	{
+		m_buckets.reset(new Bucket[numBuckets]);
+		m_numBuckets = numBuckets;
+	}
+	Clear();
+}
+
+void TranspositionTable::Clear()
+{
+	for (std::size_t i = 0; i < m_numBuckets; ++i)
+	{
+		for (HashEntry& entry : m_buckets[i].entries)
+		{
+			entry.Clear();
+		}
+	}
+	m_generation = 0;
+}
+
+bool TranspositionTable::Probe(uint64_t hash, TableHit& hit) const
+{
+	for (const HashEntry& entry : GetBucket(hash).entries)
+	{
+		uint64_t data = 0;
+		if (!entry.Load(hash, data))
+		{
+			continue;
+		}
+
+		hit.bound = static_cast<BoundId>((data >> s_boundShift) & 3);
+		if (hit.bound == BoundId::NONE)
+		{
+			return false;
+		}
+		hit.move = Move::FromData(static_cast<uint16_t>(data));
+		hit.score = static_cast<int16_t>(data >> s_scoreShift);
+		hit.depth = GetDepth(data);
+		return true;
+	}
+	return false;
+}
+
+void TranspositionTable::Store(uint64_t hash, Move move, int32_t score, int32_t depth, BoundId bound)
+{
+	Bucket& bucket = GetBucket(hash);
+
+	// Pick the entry already holding the position, or else the least valuable one.
+	HashEntry* replace = nullptr;
+	uint64_t replaceData = 0;
+	int32_t replaceWorth = 0;
+	bool isSamePosition = false;
+	for (HashEntry& entry : bucket.entries)
+	{
+		uint64_t data = 0;
+		if (entry.Load(hash, data))
+		{
+			replace = &entry;
+			replaceData = data;
+			isSamePosition = true;
+			break;
+		}
+
+		int32_t age = (m_generation - GetGeneration(data)) & s_generationMask;
+		int32_t worth = GetDepth(data) - s_agePenalty * age;
+		if (!replace || worth < replaceWorth)
+		{
+			replace = &entry;
+			replaceData = data;
+			replaceWorth = worth;
+		}
+	}
+
+	if (isSamePosition)
+	{
+		// A result with no move keeps the move found before; only a much shallower
+		// result from the same search keeps the old one entirely.
+		if (move == Move::None())
+		{
+			move = Move::FromData(static_cast<uint16_t>(replaceData));
+		}
+		if (bound != BoundId::EXACT && GetGeneration(replaceData) == m_generation
+			&& depth + s_sameKeyDepthMargin < GetDepth(replaceData))
+		{
+			return;
+		}
+	}
+
+	uint64_t data = move.GetData()
+		| (static_cast<uint64_t>(static_cast<uint16_t>(score)) << s_scoreShift)
+		| (static_cast<uint64_t>(std::clamp(depth, 0, 255)) << s_depthShift)
+		| (static_cast<uint64_t>(bound) << s_boundShift)
+		| (static_cast<uint64_t>(m_generation) << s_generationShift);
+	replace->Save(hash, data);
+}
+
+int32_t TranspositionTable::GetHashfull() const
+{
+	const std::size_t numSampled = std::min<std::size_t>(m_numBuckets, 1000);
+	int32_t numUsed = 0;
+	for (std::size_t i = 0; i < numSampled; ++i)
+	{
+		for (const HashEntry& entry : m_buckets[i].entries)
+		{
+			uint64_t data = entry.data.load(std::memory_order_relaxed);
+			numUsed += ((data >> s_boundShift) & 3) != 0 && GetGeneration(data) == m_generation;
+		}
+	}
+	return static_cast<int32_t>(numUsed * 1000 / static_cast<int32_t>(numSampled * s_bucketSize));
+}
+
+//===============================================================================
+
+} // namespace Chess
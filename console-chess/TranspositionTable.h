@@ -0,0 +1,107 @@
+//---------------------------------------------------------------
+//
+// TranspositionTable.h
+//
+
+#pragma once
+
+#include "HashEntry.h"
+#include "Move.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Chess {
+
+//===============================================================================
+
+// How a stored score relates to the true score of the position.
+enum struct BoundId : uint8_t {
+	NONE = 0,
+
+	// The true score is at most the stored one: every move failed low.
+	UPPER,
+
+	// The true score is at least the stored one: a move failed high.
+	LOWER,
+
+	// The stored score is the true score.
+	EXACT
+};
+
+// What a probe found for a position.
+struct TableHit {
+	Move move = Move::None();
+	int32_t score = 0;
+	int32_t depth = 0;
+	BoundId bound = BoundId::NONE;
+};
+
+// Search results keyed by Zobrist hash, shared by any number of search threads without locks
+// through HashEntry. Four entries fill a 64-byte bucket, one cache line, and a position may
+// only be stored in its bucket.
+class TranspositionTable {
+public:
+	explicit TranspositionTable(std::size_t megabytes = s_defaultMegabytes);
+
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+	static constexpr std::size_t s_defaultMegabytes = 16;
+
+	// Reallocates the table with the largest power of two number of buckets that fits in the
+	// given size, at least one. Drops every entry. Must not be called during a search.
+	void Resize(std::size_t megabytes);
+
+	// Drops every entry. Must not be called during a search.
+	void Clear();
+
+	// Marks the start of a new search. Entries from earlier searches are replaced first.
+	void NewSearch() { m_generation = (m_generation + 1) & s_generationMask; }
+
+	// Returns whether the position is stored, and if so fills hit.
+	bool Probe(uint64_t hash, TableHit& hit) const;
+
+	// Stores a search result, replacing the entry for the same position if it is in the
+	// bucket, and otherwise the shallowest entry, counting those from earlier searches as
+	// shallower.
+	void Store(uint64_t hash, Move move, int32_t score, int32_t depth, BoundId bound);
+
+	// Returns how full the table is in permille, sampled from the entries of the current search
+	// in the first thousand buckets.
+	int32_t GetHashfull() const;
+
+	std::size_t GetSizeBytes() const { return m_numBuckets * sizeof(Bucket); }
+
+private:
+	// Data word layout, low bits first: move (16), score (16), depth (8), bound (2),
+	// generation (6). The top 16 bits are unused.
+	static constexpr int32_t s_scoreShift = 16;
+	static constexpr int32_t s_depthShift = 32;
+	static constexpr int32_t s_boundShift = 40;
+	static constexpr int32_t s_generationShift = 42;
+	static constexpr uint32_t s_generationMask = 0x3F;
+
+	static constexpr int32_t s_bucketSize = 4;
+
+	struct alignas(64) Bucket {
+		HashEntry entries[s_bucketSize];
+	};
+
+	static_assert(sizeof(Bucket) == 64, "Bucket must fill one cache line");
+
+	Bucket& GetBucket(uint64_t hash) const { return m_buckets[hash & (m_numBuckets - 1)]; }
+
+	static uint32_t GetGeneration(uint64_t data) { return (data >> s_generationShift) & s_generationMask; }
+	static int32_t GetDepth(uint64_t data) { return static_cast<uint8_t>(data >> s_depthShift); }
+
+private:
+	std::unique_ptr<Bucket[]> m_buckets;
+	std::size_t m_numBuckets = 0;
+	uint32_t m_generation = 0;
+};
+
+//===============================================================================
+
+} // namespace Chess
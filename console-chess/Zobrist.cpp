@@ -0,0 +1,51 @@
+//---------------------------------------------------------------
+//
+// Zobrist.cpp
+//
+
+#include "Zobrist.h"
+
+#include <cstddef>
+
+namespace Chess {
+
+//===============================================================================
+
+// splitmix64. The keys only need to be well mixed and the same on every run.
+static uint64_t NextZobristKey(uint64_t& state)
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+const ZobristKeys s_zobrist = [] {
+	ZobristKeys keys{};
+	uint64_t state = 0x2545F4914F6CDD1DULL;
+	for (auto& colorKeys : keys.pieces)
+	{
+		for (auto& pieceKeys : colorKeys)
+		{
+			for (uint64_t& key : pieceKeys)
+			{
+				key = NextZobristKey(state);
+			}
+		}
+	}
+	// No rights hashes to zero, so an empty board with white to move has key zero.
+	for (std::size_t i = 1; i < keys.castling.size(); ++i)
+	{
+		keys.castling[i] = NextZobristKey(state);
+	}
+	for (uint64_t& key : keys.enPassantFile)
+	{
+		key = NextZobristKey(state);
+	}
+	keys.blackToMove = NextZobristKey(state);
+	return keys;
+}();
+
+//===============================================================================
+
+} // namespace Chess
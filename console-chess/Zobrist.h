@@ -0,0 +1,37 @@
+//---------------------------------------------------------------
+//
+// Zobrist.h
+//
+
+#pragma once
+
+#include "ChessTypes.h"
+
+#include <array>
+
+namespace Chess {
+
+//===============================================================================
+
+// Random keys XORed together to hash a position. A position's key is the XOR of the key of
+// every piece on its square, the castling rights, the en-passant file if there is one, and
+// the side key when black is to move.
+struct ZobristKeys {
+	std::array<std::array<std::array<uint64_t, s_numSquares>, s_numPieceTypes>, s_numColors> pieces;
+	// Indexed by the castling rights bitmask. Entry 0 is zero.
+	std::array<uint64_t, 16> castling;
+	std::array<uint64_t, 8> enPassantFile;
+	uint64_t blackToMove;
+};
+
+extern const ZobristKeys s_zobrist;
+
+// Returns the key of a piece of the given kind and color on the square.
+inline uint64_t GetPieceKey(ColorId colorId, PieceId pieceId, Square square)
+{
+	return s_zobrist.pieces[ColorIndex(colorId)][PieceIndex(pieceId)][square];
+}
+
+//===============================================================================
+
+} // namespace Chess
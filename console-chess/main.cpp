@@ -3,12 +3,279 @@
 // main.cpp
 //
 
+#include "Bitboard.h"
+#include "Evaluate.h"
 #include "GameController.h"
+#include "Perft.h"
+#include "Search.h"
 
-int main()
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Usage:
+//   console-chess [options]        Plays a game on the console.
+//   console-chess perft [options]  Runs the perft suite.
+//   console-chess perft [options] <depth> [options] [fen]
+//                                  Prints a perft divide of the position, the start position by default.
+//   console-chess see              Runs the static exchange evaluation suite.
+//   console-chess bench [options] [depth]
+//                                  Searches a fixed set of positions to a depth, 8 by default,
+//                                  and prints the time to depth of each.
+//   console-chess analyze [options] [fen]
+//                                  Searches the position, the start position by default, and prints
+//                                  each iteration.
+// Game options:
+//   --computer <white|black>  Side the computer plays. By default both sides are played from the console.
+//   --depth, --nodes, --movetime
+//                             Limits for the computer's search, as for analyze. Defaults to 1000 ms.
+//   --hash, --threads, --parallel
+//                             Size of the computer's transposition table and how many threads
+//                             it searches with, as for analyze.
+// Perft options:
+//   --threads <n>  Threads to run perft on. Defaults to every hardware thread.
+//   --hash <mb>    Size of the subtree count cache. Defaults to 64, 0 disables it.
+// Analyze options:
+//   --depth <n>      Deepest iteration to search.
+//   --nodes <n>      Nodes to search at most.
+//   --movetime <ms>  Time to search for. Without any limit the search stops at depth 8.
+//   --hash <mb>      Size of the transposition table. Defaults to 16.
+//   --threads <n>    Threads to search with. Defaults to 1, 0 uses every hardware thread.
+//   --parallel <lazysmp|ybwc>
+//                    How the threads share the work: each searching the whole tree through a
+//                    shared hash table, or splitting nodes between them. Defaults to lazysmp.
+// Bench options:
+//   --hash, --threads, --parallel
+//                    As for analyze.
+
+// Reads a search limit option and its value into limits. Returns false if it is not one.
+static bool ParseSearchLimit(const std::string& option, const char* value, Chess::SearchLimits& limits)
+{
+	if (option == "--depth")
+	{
+		limits.maxDepth = std::atoi(value);
+	}
+	else if (option == "--nodes")
+	{
+		limits.maxNodes = std::strtoull(value, nullptr, 10);
+	}
+	else if (option == "--movetime")
+	{
+		limits.moveTime = std::chrono::milliseconds(std::atoi(value));
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+// Reads a search option and its value into options. Returns false if it is not one.
+static bool ParseSearchOption(const std::string& option, const char* value, Chess::SearchOptions& options)
+{
+	if (option == "--hash")
+	{
+		options.hashMegabytes = static_cast<std::size_t>(std::atoi(value));
+	}
+	else if (option == "--threads")
+	{
+		options.numThreads = std::atoi(value);
+	}
+	else if (option == "--parallel" && (std::string(value) == "lazysmp" || std::string(value) == "ybwc"))
+	{
+		options.parallelSearch = std::string(value) == "ybwc"
+			? Chess::ParallelSearchId::YBWC : Chess::ParallelSearchId::LAZY_SMP;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+// Returns the FEN spread over the arguments from argIndex on, since it has spaces in it and
+// may be given either quoted or not.
+static std::string JoinFen(int argc, char* argv[], int argIndex)
+{
+	std::string fen;
+	for (int i = argIndex; i < argc; ++i)
+	{
+		fen += (i > argIndex ? " " : "") + std::string(argv[i]);
+	}
+	return fen;
+}
+
+// Reads the perft options starting at argIndex and returns the index of the first argument
+// that is not one.
+static int ParsePerftOptions(int argc, char* argv[], int argIndex, Chess::PerftOptions& options)
+{
+	while (argIndex + 1 < argc)
+	{
+		std::string option = argv[argIndex];
+		if (option == "--threads")
+		{
+			options.numThreads = std::atoi(argv[argIndex + 1]);
+		}
+		else if (option == "--hash")
+		{
+			options.hashMegabytes = static_cast<std::size_t>(std::atoi(argv[argIndex + 1]));
+		}
+		else
+		{
+			break;
+		}
+		argIndex += 2;
+	}
+	return argIndex;
+}
+
+static int RunPerft(int argc, char* argv[])
+{
+	Chess::PerftOptions options;
+	options.numThreads = 0;
+	options.hashMegabytes = 64;
+
+	int argIndex = ParsePerftOptions(argc, argv, 2, options);
+
+	if (argIndex >= argc)
+	{
+		return Chess::RunPerftSuite(options, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	int32_t depth = std::atoi(argv[argIndex]);
+	if (depth < 1)
+	{
+		std::cerr << "Perft depth must be at least 1.\n";
+		return EXIT_FAILURE;
+	}
+
+	// Options may come after the depth too, but not after the FEN.
+	argIndex = ParsePerftOptions(argc, argv, argIndex + 1, options);
+	std::string fen = JoinFen(argc, argv, argIndex);
+	Chess::Position position;
+	if (!position.SetFromFen(fen.empty() ? Chess::s_startFen : fen))
+	{
+		std::cerr << "Invalid FEN: " << fen << "\n";
+		return EXIT_FAILURE;
+	}
+
+	Chess::PerftDivide(position, depth, options, std::cout);
+	return EXIT_SUCCESS;
+}
+
+static int RunAnalyze(int argc, char* argv[])
+{
+	Chess::SearchLimits limits;
+	Chess::SearchOptions options;
+	bool hasLimit = false;
+
+	int argIndex = 2;
+	while (argIndex + 1 < argc)
+	{
+		if (ParseSearchLimit(argv[argIndex], argv[argIndex + 1], limits))
+		{
+			hasLimit = true;
+		}
+		else if (!ParseSearchOption(argv[argIndex], argv[argIndex + 1], options))
+		{
+			break;
+		}
+		argIndex += 2;
+	}
+	if (!hasLimit)
+	{
+		limits.maxDepth = 8;
+	}
+
+	std::string fen = JoinFen(argc, argv, argIndex);
+	Chess::Position position;
+	if (!position.SetFromFen(fen.empty() ? Chess::s_startFen : fen))
+	{
+		std::cerr << "Invalid FEN: " << fen << "\n";
+		return EXIT_FAILURE;
+	}
+
+	Chess::Search search(options);
+	Chess::SearchInfo info = search.Run(position, {}, limits,
+		[](const Chess::SearchInfo& iteration)
+	{
+		Chess::PrintSearchInfo(iteration, std::cout);
+	});
+
+	std::cout << "bestmove " << (info.pv.empty() ? "(none)" : Chess::GetMoveString(info.pv.front())) << "\n";
+	return EXIT_SUCCESS;
+}
+
+static int RunBench(int argc, char* argv[])
+{
+	Chess::SearchOptions options;
+	int argIndex = 2;
+	while (argIndex + 1 < argc && ParseSearchOption(argv[argIndex], argv[argIndex + 1], options))
+	{
+		argIndex += 2;
+	}
+
+	int32_t depth = argIndex < argc ? std::atoi(argv[argIndex]) : 8;
+	if (depth < 1)
+	{
+		std::cerr << "Bench depth must be at least 1.\n";
+		return EXIT_FAILURE;
+	}
+
+	Chess::RunSearchBench(options, depth, std::cout);
+	return EXIT_SUCCESS;
+}
+
+static int RunGame(int argc, char* argv[])
 {
-	Chess::GameController gc;
+	Chess::ColorId computerColorId = Chess::ColorId::NONE;
+	Chess::SearchLimits limits;
+	limits.moveTime = std::chrono::milliseconds(1000);
+	Chess::SearchOptions options;
+
+	for (int argIndex = 1; argIndex + 1 < argc; argIndex += 2)
+	{
+		std::string option = argv[argIndex];
+		std::string value = argv[argIndex + 1];
+		if (option == "--computer" && (value == "white" || value == "black"))
+		{
+			computerColorId = value == "white" ? Chess::ColorId::WHITE : Chess::ColorId::BLACK;
+		}
+		else if (!ParseSearchLimit(option, argv[argIndex + 1], limits)
+			&& !ParseSearchOption(option, argv[argIndex + 1], options))
+		{
+			std::cerr << "Unknown option: " << option << " " << value << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	Chess::GameController gc(computerColorId, limits, options);
 	gc.Run();
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+	Chess::InitAttackTables();
+	std::clog << "Slider attacks: " << Chess::GetSliderKernelName() << "\n";
+
+	if (argc > 1 && std::string(argv[1]) == "perft")
+	{
+		return RunPerft(argc, argv);
+	}
+	if (argc > 1 && std::string(argv[1]) == "see")
+	{
+		return Chess::RunExchangeSuite(std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if (argc > 1 && std::string(argv[1]) == "bench")
+	{
+		return RunBench(argc, argv);
+	}
+	if (argc > 1 && std::string(argv[1]) == "analyze")
+	{
+		return RunAnalyze(argc, argv);
+	}
 
-	return 0;
+	return RunGame(argc, argv);
 }